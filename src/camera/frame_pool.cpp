@@ -0,0 +1,88 @@
+#include "frame_pool.hpp"
+#include <stdexcept>
+
+namespace rt {
+
+FramePool::Handle::Handle(const Handle& other) : slot_(other.slot_) {
+    if (slot_) {
+        slot_->refCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FramePool::Handle::Handle(Handle&& other) noexcept : slot_(other.slot_) {
+    other.slot_ = nullptr;
+}
+
+FramePool::Handle& FramePool::Handle::operator=(const Handle& other) {
+    if (this != &other) {
+        Handle copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+FramePool::Handle& FramePool::Handle::operator=(Handle&& other) noexcept {
+    if (this != &other) {
+        reset();
+        slot_ = other.slot_;
+        other.slot_ = nullptr;
+    }
+    return *this;
+}
+
+FramePool::Handle::~Handle() {
+    reset();
+}
+
+void FramePool::Handle::reset() {
+    if (slot_) {
+        // Release pairs with the acquire in FramePool::acquire() so the next
+        // owner sees every write made to the frame through this handle
+        slot_->refCount.fetch_sub(1, std::memory_order_acq_rel);
+        slot_ = nullptr;
+    }
+}
+
+FramePool::FramePool(std::size_t capacity, int width, int height, int type)
+    : slots_(std::make_unique<Slot[]>(capacity))
+    , capacity_(capacity) {
+
+    if (capacity == 0 || width <= 0 || height <= 0) {
+        throw std::invalid_argument("Frame pool needs a non-zero capacity and frame size");
+    }
+
+    for (std::size_t i = 0; i < capacity_; ++i) {
+        slots_[i].frame.create(height, width, type);
+    }
+}
+
+FramePool::Handle FramePool::acquire() {
+    // Start scanning after the last handed-out slot so frames are recycled
+    // round-robin instead of hammering slot 0
+    const std::size_t start = nextSlot_.load(std::memory_order_relaxed);
+
+    for (std::size_t i = 0; i < capacity_; ++i) {
+        const std::size_t index = (start + i) % capacity_;
+        int expected = 0;
+        if (slots_[index].refCount.compare_exchange_strong(
+                expected, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            nextSlot_.store(index + 1, std::memory_order_relaxed);
+            return Handle(&slots_[index]);
+        }
+    }
+
+    exhaustions_.fetch_add(1, std::memory_order_relaxed);
+    return Handle();
+}
+
+std::size_t FramePool::available() const {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < capacity_; ++i) {
+        if (slots_[i].refCount.load(std::memory_order_relaxed) == 0) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+} // namespace rt
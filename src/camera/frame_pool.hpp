@@ -0,0 +1,74 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace rt {
+
+// Fixed-size pool of pre-allocated frames handed out as reference-counted
+// handles. All pixel memory is allocated in the constructor; acquiring and
+// releasing a frame afterwards never touches the heap, which keeps page
+// faults and allocator locks out of the RT capture path.
+class FramePool {
+    struct Slot {
+        cv::Mat frame;
+        std::chrono::nanoseconds timestamp{0};
+        uint64_t sequence{0};
+        std::atomic<int> refCount{0};
+    };
+
+public:
+    // Shared ownership of one pool frame. The frame goes back to the pool
+    // when the last handle referring to it is reset or destroyed.
+    class Handle {
+    public:
+        Handle() = default;
+        Handle(const Handle& other);
+        Handle(Handle&& other) noexcept;
+        Handle& operator=(const Handle& other);
+        Handle& operator=(Handle&& other) noexcept;
+        ~Handle();
+
+        explicit operator bool() const { return slot_ != nullptr; }
+        cv::Mat& frame() const { return slot_->frame; }
+        void reset();
+
+        // Capture metadata, written by the producer before publishing
+        std::chrono::nanoseconds timestamp() const { return slot_->timestamp; }
+        uint64_t sequence() const { return slot_->sequence; }
+        void stamp(uint64_t sequence, std::chrono::nanoseconds timestamp) const {
+            slot_->sequence = sequence;
+            slot_->timestamp = timestamp;
+        }
+
+    private:
+        friend class FramePool;
+        explicit Handle(Slot* slot) : slot_(slot) {}
+
+        Slot* slot_ = nullptr;
+    };
+
+    FramePool(std::size_t capacity, int width, int height, int type = CV_8UC3);
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // Returns an empty handle and counts an exhaustion if every frame is in use
+    Handle acquire();
+
+    std::size_t capacity() const { return capacity_; }
+    std::size_t available() const;
+    uint64_t exhaustionCount() const { return exhaustions_.load(std::memory_order_relaxed); }
+
+private:
+    std::unique_ptr<Slot[]> slots_;
+    std::size_t capacity_;
+    std::atomic<std::size_t> nextSlot_{0};
+    std::atomic<uint64_t> exhaustions_{0};
+};
+
+} // namespace rt
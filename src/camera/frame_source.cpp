@@ -0,0 +1,88 @@
+#include "frame_source.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace rt {
+
+DeviceFrameSource::DeviceFrameSource(int deviceId, int width, int height, int fps,
+                                     PixelFormat format)
+    : capture_(std::make_unique<cv::VideoCapture>())
+    , size_(width, height)
+    , format_(format) {
+
+    if (!capture_->open(deviceId)) {
+        throw std::runtime_error("Failed to open camera " + std::to_string(deviceId));
+    }
+
+    capture_->set(cv::CAP_PROP_FRAME_WIDTH, width);
+    capture_->set(cv::CAP_PROP_FRAME_HEIGHT, height);
+    capture_->set(cv::CAP_PROP_FPS, fps);
+
+    // The format is negotiated before streaming starts, i.e. before the
+    // first grab. Only YUYV skips the backend's BGR conversion.
+    if (format == PixelFormat::YUYV) {
+        capture_->set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('Y', 'U', 'Y', 'V'));
+        capture_->set(cv::CAP_PROP_CONVERT_RGB, 0);
+    } else if (format == PixelFormat::MJPEG) {
+        capture_->set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'));
+    }
+}
+
+bool DeviceFrameSource::read(cv::Mat& frame, std::chrono::nanoseconds& timestamp) {
+    const bool read = format_ == PixelFormat::YUYV ? capture_->grab() && retrievePacked(frame)
+                                                   : capture_->read(frame);
+    if (!read) {
+        return false;
+    }
+
+    // read() blocks until the driver delivers the frame, so the time it
+    // returns is the closest monotonic estimate of the capture instant
+    timestamp = now();
+    return true;
+}
+
+bool DeviceFrameSource::grab(std::chrono::nanoseconds& timestamp) {
+    // Dequeues the driver's buffer without converting it; stamped like read()
+    if (!capture_->grab()) {
+        return false;
+    }
+    timestamp = now();
+    return true;
+}
+
+bool DeviceFrameSource::retrieve(cv::Mat& frame) {
+    return format_ == PixelFormat::YUYV ? retrievePacked(frame) : capture_->retrieve(frame);
+}
+
+void DeviceFrameSource::release() {
+    capture_->release();
+}
+
+bool DeviceFrameSource::retrievePacked(cv::Mat& frame) {
+    // Unconverted frames come out as one row of bytes (1 x w*h*2, CV_8UC1).
+    // Retrieving into a byte header of the same shape over frame makes the
+    // backend write into frame's buffer, a pooled one, instead of handing
+    // out a new one every frame.
+    frame.create(size_, CV_8UC2);  // Nothing to do for a pooled frame
+    cv::Mat bytes = frame.reshape(1, 1);
+    const uchar* const storage = bytes.data;
+    if (!capture_->retrieve(bytes)) {
+        return false;
+    }
+    if (bytes.total() * bytes.elemSize() != frame.total() * frame.elemSize()) {
+        return false;  // Not the negotiated format
+    }
+    if (bytes.data != storage) {
+        // The backend replaced the header, e.g. with a view of its own buffer
+        cv::Mat target = frame.reshape(1, 1);
+        bytes.copyTo(target);
+    }
+    return true;
+}
+
+std::chrono::nanoseconds DeviceFrameSource::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch());
+}
+
+} // namespace rt
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <memory>
+
+namespace rt {
+
+// What a camera transfers. BGR and MJPEG frames reach the caller as BGR8
+// (MJPEG is decoded by the capture backend). YUYV frames are handed out
+// packed, CV_8UC2 with Y in channel 0 and U/V alternating in channel 1, so
+// colour conversion can wait for the stage that downscales them.
+enum class PixelFormat { BGR, YUYV, MJPEG };
+
+// OpenCV type of the frames a source of this format delivers
+inline int frameType(PixelFormat format) {
+    return format == PixelFormat::YUYV ? CV_8UC2 : CV_8UC3;
+}
+
+// Where StereoCaptureSystem gets its frames from. Implementations fill the
+// caller's frame in place (so pooled buffers are reused) and report the
+// capture time on the monotonic clock.
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    virtual bool read(cv::Mat& frame, std::chrono::nanoseconds& timestamp) = 0;
+    virtual void release() = 0;
+
+    // read() in two halves: grab() latches the next frame and stamps it
+    // without decoding, retrieve() decodes the latched frame. Grabbing
+    // several sources back to back before retrieving any keeps their
+    // capture instants as close together as the grabs.
+    virtual bool grab(std::chrono::nanoseconds& timestamp) = 0;
+    virtual bool retrieve(cv::Mat& frame) = 0;
+};
+
+// Live V4L2/USB camera opened by device index
+class DeviceFrameSource : public FrameSource {
+public:
+    DeviceFrameSource(int deviceId, int width, int height, int fps,
+                      PixelFormat format = PixelFormat::BGR);
+
+    bool read(cv::Mat& frame, std::chrono::nanoseconds& timestamp) override;
+    void release() override;
+    bool grab(std::chrono::nanoseconds& timestamp) override;
+    bool retrieve(cv::Mat& frame) override;
+
+private:
+    static std::chrono::nanoseconds now();
+    bool retrievePacked(cv::Mat& frame);
+
+    std::unique_ptr<cv::VideoCapture> capture_;
+    cv::Size size_;
+    PixelFormat format_;
+};
+
+} // namespace rt
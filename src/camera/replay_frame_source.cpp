@@ -0,0 +1,122 @@
+#include "replay_frame_source.hpp"
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+#include <thread>
+
+namespace rt {
+
+namespace {
+
+bool hasRawExtension(const std::string& path) {
+    const std::string ext = ".raw";
+    return path.size() >= ext.size() &&
+           path.compare(path.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+} // namespace
+
+ReplayFrameSource::ReplayFrameSource(const Config& config)
+    : config_(config)
+    , isRaw_(hasRawExtension(config.path)) {
+
+    if (config.width <= 0 || config.height <= 0 || config.fps <= 0.0) {
+        throw std::invalid_argument("Replay source needs a positive frame size and fps");
+    }
+    if (config.format == PixelFormat::YUYV && !isRaw_) {
+        throw std::invalid_argument("Packed YUYV replay needs a raw dump");
+    }
+
+    period_ = std::chrono::nanoseconds(static_cast<int64_t>(1e9 / config.fps));
+
+    if (isRaw_) {
+        raw_.open(config.path, std::ios::binary);
+        if (!raw_) {
+            throw std::runtime_error("Failed to open raw replay file " + config.path);
+        }
+        return;
+    }
+
+    if (!video_.open(config.path)) {
+        throw std::runtime_error("Failed to open replay sequence " + config.path);
+    }
+
+    // Image sequences may not report a size; only reject a known mismatch
+    const int width = static_cast<int>(video_.get(cv::CAP_PROP_FRAME_WIDTH));
+    const int height = static_cast<int>(video_.get(cv::CAP_PROP_FRAME_HEIGHT));
+    if (width > 0 && height > 0 && (width != config.width || height != config.height)) {
+        throw std::runtime_error("Replay sequence " + config.path + " is " +
+                                 std::to_string(width) + "x" + std::to_string(height) +
+                                 ", expected " + std::to_string(config.width) + "x" +
+                                 std::to_string(config.height));
+    }
+}
+
+bool ReplayFrameSource::read(cv::Mat& frame, std::chrono::nanoseconds& timestamp) {
+    return grab(timestamp) && retrieve(frame);
+}
+
+bool ReplayFrameSource::grab(std::chrono::nanoseconds& timestamp) {
+    if (frameIndex_ == 0) {
+        start_ = std::chrono::steady_clock::now();
+    }
+
+    if (config_.pacing == Pacing::RealTime) {
+        std::this_thread::sleep_until(start_ + period_ * frameIndex_);
+    }
+
+    if (!grabNext()) {
+        if (!config_.loop || !rewind() || !grabNext()) {
+            return false;
+        }
+    }
+
+    timestamp = period_ * frameIndex_;
+    ++frameIndex_;
+    return true;
+}
+
+bool ReplayFrameSource::retrieve(cv::Mat& frame) {
+    return isRaw_ ? readRaw(frame) : video_.retrieve(frame);
+}
+
+void ReplayFrameSource::release() {
+    if (isRaw_) {
+        raw_.close();
+    } else {
+        video_.release();
+    }
+}
+
+bool ReplayFrameSource::grabNext() {
+    // Raw frames are read in retrieve(); here only check one is left
+    if (isRaw_) {
+        return raw_.peek() != std::ifstream::traits_type::eof();
+    }
+    return video_.grab();
+}
+
+bool ReplayFrameSource::readRaw(cv::Mat& frame) {
+    // No-op for pooled frames that already have the recorded geometry
+    frame.create(config_.height, config_.width, frameType(config_.format));
+
+    const std::streamsize rowBytes = static_cast<std::streamsize>(frame.cols * frame.elemSize());
+    for (int y = 0; y < frame.rows; ++y) {
+        if (!raw_.read(reinterpret_cast<char*>(frame.ptr(y)), rowBytes)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ReplayFrameSource::rewind() {
+    spdlog::debug("Replay {} reached the end, rewinding", config_.path);
+
+    if (isRaw_) {
+        raw_.clear();
+        raw_.seekg(0);
+        return static_cast<bool>(raw_);
+    }
+    return video_.set(cv::CAP_PROP_POS_FRAMES, 0);
+}
+
+} // namespace rt
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include "frame_source.hpp"
+
+namespace rt {
+
+// Plays back a recorded sequence for one eye. The path may be anything
+// cv::VideoCapture opens (video file, "frame_%06d.png" image sequence) or a
+// raw dump ending in ".raw": back-to-back frames of width x height, BGR8 or,
+// for a YUYV config, packed YUYV as a camera delivers it.
+//
+// Timestamps are virtual: frame n is stamped n * (1 / fps) regardless of
+// pacing, so two replay sources started together pair up deterministically
+// and runs are reproducible on any machine.
+class ReplayFrameSource : public FrameSource {
+public:
+    enum class Pacing {
+        RealTime,          // sleep so frames are delivered at the configured fps
+        AsFastAsPossible   // never sleep; for throughput benchmarks
+    };
+
+    struct Config {
+        std::string path;
+        int width;
+        int height;
+        double fps;
+        Pacing pacing;
+        bool loop;
+        PixelFormat format{PixelFormat::BGR};
+    };
+
+    explicit ReplayFrameSource(const Config& config);
+
+    bool read(cv::Mat& frame, std::chrono::nanoseconds& timestamp) override;
+    void release() override;
+
+    // grab() paces and stamps the frame, retrieve() reads its pixels
+    bool grab(std::chrono::nanoseconds& timestamp) override;
+    bool retrieve(cv::Mat& frame) override;
+
+    uint64_t getFramesDelivered() const { return frameIndex_; }
+
+private:
+    bool grabNext();
+    bool readRaw(cv::Mat& frame);
+    bool rewind();
+
+    Config config_;
+    bool isRaw_;
+    cv::VideoCapture video_;
+    std::ifstream raw_;
+
+    std::chrono::nanoseconds period_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t frameIndex_{0};
+};
+
+} // namespace rt
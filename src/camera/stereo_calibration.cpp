@@ -0,0 +1,87 @@
+#include "stereo_calibration.hpp"
+#include <opencv2/calib3d.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace rt {
+
+StereoCalibration::StereoCalibration(const cv::Size& imageSize, const Camera& left,
+                                     const Camera& right, const cv::Matx33d& rotation,
+                                     const cv::Vec3d& translation)
+    : imageSize_(imageSize) {
+    if (imageSize.width <= 0 || imageSize.height <= 0 || cv::norm(translation) == 0.0) {
+        throw std::invalid_argument("Stereo calibration needs an image size and a baseline");
+    }
+
+    left_.camera = left;
+    right_.camera = right;
+    cv::Mat leftRotation, rightRotation, leftProjection, rightProjection, disparityToDepth;
+    cv::stereoRectify(cv::Mat(left.matrix), left.distortion, cv::Mat(right.matrix),
+                      right.distortion, imageSize, cv::Mat(rotation), cv::Mat(translation),
+                      leftRotation, rightRotation, leftProjection, rightProjection,
+                      disparityToDepth, cv::CALIB_ZERO_DISPARITY, 0.0);
+    left_.rotation = cv::Matx33d(leftRotation);
+    right_.rotation = cv::Matx33d(rightRotation);
+    left_.projection = cv::Matx34d(leftProjection);
+    right_.projection = cv::Matx34d(rightProjection);
+
+    // The right projection carries -f * baseline in its translation column
+    baseline_ = std::abs(right_.projection(0, 3) / right_.projection(0, 0));
+}
+
+StereoCalibration StereoCalibration::load(const std::string& path) {
+    cv::FileStorage file(path, cv::FileStorage::READ);
+    if (!file.isOpened()) {
+        throw std::runtime_error("Failed to open stereo calibration " + path);
+    }
+
+    auto matrix = [&](const char* key) {
+        cv::Mat value;
+        file[key] >> value;
+        if (value.empty()) {
+            throw std::runtime_error(std::string("Stereo calibration lacks ") + key);
+        }
+        value.convertTo(value, CV_64F);
+        return value;
+    };
+
+    const cv::Size size(static_cast<int>(file["image_width"]),
+                        static_cast<int>(file["image_height"]));
+    const Camera left{cv::Matx33d(matrix("M1")), matrix("D1")};
+    const Camera right{cv::Matx33d(matrix("M2")), matrix("D2")};
+    return StereoCalibration(size, left, right, cv::Matx33d(matrix("R")),
+                             cv::Vec3d(matrix("T").reshape(1, 3)));
+}
+
+cv::Rect StereoCalibration::rectify(const View& view, const cv::Rect& box) const {
+    // Lens distortion bends edges, so take the corners and edge midpoints
+    const float x0 = static_cast<float>(box.x);
+    const float y0 = static_cast<float>(box.y);
+    const float x1 = static_cast<float>(box.x + box.width);
+    const float y1 = static_cast<float>(box.y + box.height);
+    const float xm = 0.5f * (x0 + x1);
+    const float ym = 0.5f * (y0 + y1);
+    const std::array<cv::Point2f, 8> raw{{{x0, y0}, {xm, y0}, {x1, y0}, {x1, ym},
+                                          {x1, y1}, {xm, y1}, {x0, y1}, {x0, ym}}};
+    std::array<cv::Point2f, 8> rectified;
+    cv::Mat source(static_cast<int>(raw.size()), 1, CV_32FC2, const_cast<cv::Point2f*>(raw.data()));
+    cv::Mat target(static_cast<int>(rectified.size()), 1, CV_32FC2, rectified.data());
+    cv::undistortPoints(source, target, cv::Mat(view.camera.matrix), view.camera.distortion,
+                        cv::Mat(view.rotation), cv::Mat(view.projection));
+
+    float left = rectified[0].x, right = left, top = rectified[0].y, bottom = top;
+    for (const cv::Point2f& point : rectified) {
+        left = std::min(left, point.x);
+        right = std::max(right, point.x);
+        top = std::min(top, point.y);
+        bottom = std::max(bottom, point.y);
+    }
+    const cv::Point topLeft(static_cast<int>(std::floor(left)), static_cast<int>(std::floor(top)));
+    const cv::Point bottomRight(static_cast<int>(std::ceil(right)),
+                                static_cast<int>(std::ceil(bottom)));
+    return cv::Rect(topLeft, bottomRight) & cv::Rect(cv::Point(), imageSize_);
+}
+
+} // namespace rt
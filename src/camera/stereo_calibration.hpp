@@ -0,0 +1,60 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <string>
+
+namespace rt {
+
+enum class StereoEye { Left, Right };
+
+// Intrinsics and relative pose of a calibrated stereo rig, and the
+// rectification that makes its epipolar lines horizontal.
+//
+// R and T take points from the left camera frame to the right one, as
+// produced by cv::stereoCalibrate; distances come out in the units of T.
+// Rectification is computed once at construction (cv::stereoRectify with
+// alpha 0, so rectified images hold valid pixels only).
+class StereoCalibration {
+public:
+    struct Camera {
+        cv::Matx33d matrix;
+        cv::Mat distortion;  // 1xN, any model cv::undistortPoints accepts
+    };
+
+    // Rectifying rotation and projection of one camera
+    struct View {
+        Camera camera;
+        cv::Matx33d rotation;
+        cv::Matx34d projection;
+    };
+
+    StereoCalibration(const cv::Size& imageSize, const Camera& left, const Camera& right,
+                      const cv::Matx33d& rotation, const cv::Vec3d& translation);
+
+    // Reads image_width, image_height, M1, D1, M2, D2, R and T from an
+    // OpenCV FileStorage file (the names of OpenCV's stereo_calib sample)
+    static StereoCalibration load(const std::string& path);
+
+    const cv::Size& imageSize() const { return imageSize_; }
+    const View& left() const { return left_; }
+    const View& right() const { return right_; }
+    const View& view(StereoEye eye) const { return eye == StereoEye::Left ? left_ : right_; }
+
+    // Rectified focal length in pixels and baseline in units of T
+    double focalLength() const { return left_.projection(0, 0); }
+    double baseline() const { return baseline_; }
+
+    // Distance along the optical axis of a rectified disparity in pixels
+    double distance(double disparity) const { return focalLength() * baseline_ / disparity; }
+
+    // Bounding box in rectified pixels of a box in raw camera pixels
+    cv::Rect rectify(const View& view, const cv::Rect& box) const;
+
+private:
+    cv::Size imageSize_;
+    View left_;
+    View right_;
+    double baseline_;
+};
+
+} // namespace rt
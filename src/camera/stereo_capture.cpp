@@ -1,35 +1,73 @@
 #include "stereo_capture.hpp"
 #include <spdlog/spdlog.h>
+#include <chrono>
+#include <cstdlib>
 
 namespace rt {
 
+namespace {
+
+cv::Size outputSize(const StereoCaptureSystem::CameraConfig& config,
+                    const std::shared_ptr<const StereoRectifier>& rectifier) {
+    return rectifier ? rectifier->outputSize() : cv::Size(config.width, config.height);
+}
+
+int outputType(const StereoCaptureSystem::CameraConfig& config,
+               const std::shared_ptr<const StereoRectifier>& rectifier) {
+    return rectifier ? CV_8UC3 : frameType(config.format);
+}
+
+} // namespace
+
 StereoCaptureSystem::StereoCaptureSystem(const CameraConfig& leftConfig, 
-                                       const CameraConfig& rightConfig)
-    : leftConfig_(leftConfig)
-    , rightConfig_(rightConfig)
-    , leftCam_(std::make_unique<cv::VideoCapture>())
-    , rightCam_(std::make_unique<cv::VideoCapture>()) {
+                                       const CameraConfig& rightConfig,
+                                       std::shared_ptr<const StereoRectifier> rectifier)
+    : StereoCaptureSystem(
+          std::make_unique<DeviceFrameSource>(leftConfig.deviceId, leftConfig.width,
+                                              leftConfig.height, leftConfig.fps,
+                                              leftConfig.format),
+          std::make_unique<DeviceFrameSource>(rightConfig.deviceId, rightConfig.width,
+                                              rightConfig.height, rightConfig.fps,
+                                              rightConfig.format),
+          leftConfig, rightConfig, std::move(rectifier)) {
+}
+
+StereoCaptureSystem::StereoCaptureSystem(std::unique_ptr<FrameSource> leftSource,
+                                         std::unique_ptr<FrameSource> rightSource,
+                                         const CameraConfig& leftConfig,
+                                         const CameraConfig& rightConfig,
+                                         std::shared_ptr<const StereoRectifier> rectifier)
+    : leftCam_(std::move(leftSource))
+    , rightCam_(std::move(rightSource))
+    , rectifier_(std::move(rectifier))
+    , leftSize_(outputSize(leftConfig, rectifier_))
+    , rightSize_(outputSize(rightConfig, rectifier_))
+    , frameType_(outputType(leftConfig, rectifier_))
+    , leftPool_(kFramePoolSize, leftSize_.width, leftSize_.height, frameType_)
+    , rightPool_(kFramePoolSize, rightSize_.width, rightSize_.height, frameType_)
+    , mergedView_([&](cv::Mat& view) {
+          // Black in either layout
+          const cv::Scalar black = frameType_ == CV_8UC2 ? cv::Scalar(16, 128) : cv::Scalar::all(0);
+          view = cv::Mat(leftSize_.height, leftSize_.width + rightSize_.width, frameType_, black);
+      })
+    , leftConfig_(leftConfig)
+    , rightConfig_(rightConfig) {
     
-    // Open cameras
-    if (!leftCam_->open(leftConfig.deviceId)) {
-        throw std::runtime_error("Failed to open left camera");
+    if (!leftCam_ || !rightCam_) {
+        throw std::invalid_argument("Stereo capture needs a left and a right frame source");
     }
-    
-    if (!rightCam_->open(rightConfig.deviceId)) {
-        throw std::runtime_error("Failed to open right camera");
+    if (leftConfig.format != rightConfig.format) {
+        throw std::invalid_argument("Both cameras must capture the same pixel format");
+    }
+    if (rectifier_) {
+        const cv::Size& calibrated = rectifier_->inputSize();
+        if (calibrated != cv::Size(leftConfig.width, leftConfig.height) ||
+            calibrated != cv::Size(rightConfig.width, rightConfig.height)) {
+            throw std::invalid_argument("Cameras do not match the calibrated image size");
+        }
+        leftRaw_ = cv::Mat(calibrated, rt::frameType(leftConfig.format));
+        rightRaw_ = cv::Mat(calibrated, rt::frameType(rightConfig.format));
     }
-    
-    // Configure cameras
-    leftCam_->set(cv::CAP_PROP_FRAME_WIDTH, leftConfig.width);
-    leftCam_->set(cv::CAP_PROP_FRAME_HEIGHT, leftConfig.height);
-    leftCam_->set(cv::CAP_PROP_FPS, leftConfig.fps);
-    
-    rightCam_->set(cv::CAP_PROP_FRAME_WIDTH, rightConfig.width);
-    rightCam_->set(cv::CAP_PROP_FRAME_HEIGHT, rightConfig.height);
-    rightCam_->set(cv::CAP_PROP_FPS, rightConfig.fps);
-    
-    // Initialize merged frame
-    mergedFrame_ = cv::Mat(leftConfig.height, leftConfig.width * 2, CV_8UC3);
 }
 
 StereoCaptureSystem::~StereoCaptureSystem() {
@@ -37,7 +75,8 @@ StereoCaptureSystem::~StereoCaptureSystem() {
 }
 
 bool StereoCaptureSystem::captureLeftFrame(cv::Mat& frame) {
-    if (!leftCam_->read(frame)) {
+    std::chrono::nanoseconds timestamp;
+    if (!readFrame(true, frame, timestamp)) {
         spdlog::error("Failed to capture left frame");
         return false;
     }
@@ -45,40 +84,184 @@ bool StereoCaptureSystem::captureLeftFrame(cv::Mat& frame) {
 }
 
 bool StereoCaptureSystem::captureRightFrame(cv::Mat& frame) {
-    if (!rightCam_->read(frame)) {
+    std::chrono::nanoseconds timestamp;
+    if (!readFrame(false, frame, timestamp)) {
+        spdlog::error("Failed to capture right frame");
+        return false;
+    }
+    return true;
+}
+
+bool StereoCaptureSystem::captureLeftFrame(FramePool::Handle& frame) {
+    frame.reset();  // Recycle a stale frame before asking for a new one
+    frame = leftPool_.acquire();
+    if (!frame) {
+        spdlog::warn("Left frame pool exhausted");
+        return false;
+    }
+    std::chrono::nanoseconds timestamp;
+    if (!readFrame(true, frame.frame(), timestamp)) {
+        spdlog::error("Failed to capture left frame");
+        frame.reset();
+        return false;
+    }
+    frame.stamp(++leftSequence_, timestamp);
+    return true;
+}
+
+bool StereoCaptureSystem::captureRightFrame(FramePool::Handle& frame) {
+    frame.reset();  // Recycle a stale frame before asking for a new one
+    frame = rightPool_.acquire();
+    if (!frame) {
+        spdlog::warn("Right frame pool exhausted");
+        return false;
+    }
+    std::chrono::nanoseconds timestamp;
+    if (!readFrame(false, frame.frame(), timestamp)) {
         spdlog::error("Failed to capture right frame");
+        frame.reset();
+        return false;
+    }
+    frame.stamp(++rightSequence_, timestamp);
+    return true;
+}
+
+bool StereoCaptureSystem::grabPair() {
+    if (rightPending_.load(std::memory_order_acquire)) {
+        skippedTriggers_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    
+    // Nothing between the two grabs: their gap is the pair's skew
+    if (!leftCam_->grab(leftGrabTime_) || !rightCam_->grab(rightGrabTime_)) {
+        spdlog::error("Failed to grab stereo pair");
+        return false;
+    }
+    
+    const int64_t skew = std::abs((rightGrabTime_ - leftGrabTime_).count());
+    lastGrabSkew_.store(skew, std::memory_order_relaxed);
+    if (skew > maxGrabSkew_.load(std::memory_order_relaxed)) {
+        maxGrabSkew_.store(skew, std::memory_order_relaxed);
+    }
+    grabbedPairs_.fetch_add(1, std::memory_order_relaxed);
+    rightPending_.store(true, std::memory_order_release);
+    return true;
+}
+
+bool StereoCaptureSystem::retrieveLeftFrame(FramePool::Handle& frame) {
+    return retrieveFrame(true, frame);
+}
+
+bool StereoCaptureSystem::retrieveRightFrame(FramePool::Handle& frame) {
+    const bool retrieved = retrieveFrame(false, frame);
+    skipRightFrame();  // Done with the right camera either way
+    return retrieved;
+}
+
+void StereoCaptureSystem::skipRightFrame() {
+    rightPending_.store(false, std::memory_order_release);
+}
+
+StereoCaptureSystem::GrabStats StereoCaptureSystem::getGrabStats() const {
+    return GrabStats{grabbedPairs_.load(std::memory_order_relaxed),
+                     std::chrono::nanoseconds(lastGrabSkew_.load(std::memory_order_relaxed)),
+                     std::chrono::nanoseconds(maxGrabSkew_.load(std::memory_order_relaxed)),
+                     skippedTriggers_.load(std::memory_order_relaxed)};
+}
+
+bool StereoCaptureSystem::retrieveFrame(bool isLeft, FramePool::Handle& frame) {
+    frame.reset();  // Recycle a stale frame before asking for a new one
+    frame = (isLeft ? leftPool_ : rightPool_).acquire();
+    if (!frame) {
+        spdlog::warn("{} frame pool exhausted", isLeft ? "Left" : "Right");
+        return false;
+    }
+    
+    FrameSource& source = isLeft ? *leftCam_ : *rightCam_;
+    cv::Mat& target = rectifier_ ? (isLeft ? leftRaw_ : rightRaw_) : frame.frame();
+    if (!source.retrieve(target)) {
+        spdlog::error("Failed to retrieve {} frame", isLeft ? "left" : "right");
+        frame.reset();
+        return false;
+    }
+    if (rectifier_) {
+        rectifyRaw(isLeft, frame.frame());
+    }
+    
+    if (isLeft) {
+        frame.stamp(++leftSequence_, leftGrabTime_);
+    } else {
+        frame.stamp(++rightSequence_, rightGrabTime_);
+    }
+    return true;
+}
+
+bool StereoCaptureSystem::readFrame(bool isLeft, cv::Mat& frame,
+                                    std::chrono::nanoseconds& timestamp) {
+    FrameSource& source = isLeft ? *leftCam_ : *rightCam_;
+    if (!rectifier_) {
+        return source.read(frame, timestamp);
+    }
+    
+    cv::Mat& raw = isLeft ? leftRaw_ : rightRaw_;
+    if (!source.read(raw, timestamp)) {
         return false;
     }
+    rectifyRaw(isLeft, frame);
     return true;
 }
 
-void StereoCaptureSystem::updateMergedView(const cv::Mat& frame, bool isLeft) {
+void StereoCaptureSystem::rectifyRaw(bool isLeft, cv::Mat& frame) {
+    // The tables blend whole pixels, which packed chroma is not
+    const cv::Mat* raw = isLeft ? &leftRaw_ : &rightRaw_;
+    if (raw->type() == CV_8UC2) {
+        cv::Mat& bgr = isLeft ? leftBgr_ : rightBgr_;
+        cv::cvtColor(*raw, bgr, cv::COLOR_YUV2BGR_YUY2);
+        raw = &bgr;
+    }
+    
+    // One lookup rectifies and, for a smaller output, downscales
+    rectifier_->rectify(isLeft ? StereoEye::Left : StereoEye::Right, *raw, frame);
+}
+
+uint64_t StereoCaptureSystem::getPoolExhaustions() const {
+    return leftPool_.exhaustionCount() + rightPool_.exhaustionCount();
+}
+
+bool StereoCaptureSystem::updateMergedView(const cv::Mat& frame, bool isLeft) {
+    if (frame.empty() || frame.type() != frameType_ || frame.size() != frameSize(isLeft)) {
+        spdlog::error("Frame does not match the {} camera configuration",
+                      isLeft ? "left" : "right");
+        return false;
+    }
+    
     cv::Rect roi;
     if (isLeft) {
         roi = cv::Rect(0, 0, frame.cols, frame.rows);
     } else {
-        roi = cv::Rect(frame.cols, 0, frame.cols, frame.rows);
+        roi = cv::Rect(leftSize_.width, 0, frame.cols, frame.rows);
     }
     
-    // Copy frame to the appropriate side of the merged view
-    frame.copyTo(mergedFrame_(roi));
-    
-    // Optional: Add vertical separator line
-    cv::line(mergedFrame_, 
-             cv::Point(frame.cols, 0),
-             cv::Point(frame.cols, frame.rows),
-             cv::Scalar(0, 255, 0), 2);
+    // Copy frame to the appropriate side of the view being assembled
+    cv::Mat& mergedFrame = mergedView_.back();
+    frame.copyTo(mergedFrame(roi));
     
-    // Optional: Add labels
-    std::string label = isLeft ? "Left Camera" : "Right Camera";
-    cv::putText(mergedFrame_, label,
-                cv::Point(roi.x + 10, 30),
-                cv::FONT_HERSHEY_SIMPLEX, 1.0,
-                cv::Scalar(0, 255, 0), 2);
+    // Publish once both halves of the back buffer are current
+    pendingHalves_ |= isLeft ? kLeftHalf : kRightHalf;
+    if (pendingHalves_ == (kLeftHalf | kRightHalf)) {
+        mergedView_.publish();
+        pendingHalves_ = 0;
+    }
+    return true;
 }
 
-cv::Mat StereoCaptureSystem::getMergedFrame() const {
-    return mergedFrame_.clone();
+cv::Mat StereoCaptureSystem::getMergedFrame() {
+    mergedView_.update();
+    if (frameType_ != CV_8UC2) {
+        return mergedView_.front();
+    }
+    cv::cvtColor(mergedView_.front(), convertedView_, cv::COLOR_YUV2BGR_YUY2);
+    return convertedView_;
 }
 
 void StereoCaptureSystem::stop() {
@@ -9,6 +9,10 @@
 #include <alchemy/task.h>
 #include "../utils/logger.hpp"
 #include "../utils/performance_monitor.hpp"
+#include "frame_pool.hpp"
+#include "frame_source.hpp"
+#include "stereo_rectifier.hpp"
+#include "../utils/triple_buffer.hpp"
 
 namespace rt {
 
@@ -23,17 +27,81 @@ public:
         int height;
         int fps;
         int cpuCore;
+        PixelFormat format{PixelFormat::BGR};  // both cameras must agree
     };
 
+    // Frames per camera pool; must cover every stage that can hold a frame:
+    // the 4 capture ring slots, StereoSynchronizer::kMaxPending (4), the
+    // pair being preprocessed and the 4 detection inputs, which keep their
+    // pair for the depth stage. That is 13, plus one spare.
+    static constexpr std::size_t kFramePoolSize = 14;
+
+    // Opens the two cameras named by the configs' device ids. With a
+    // rectifier, pooled frames are rectified (and sized to its output)
+    // before they are handed out, which needs BGR: YUYV frames are then
+    // converted here. Without one they stay packed until preprocessing.
     StereoCaptureSystem(const CameraConfig& leftConfig, 
-                       const CameraConfig& rightConfig);
+                       const CameraConfig& rightConfig,
+                       std::shared_ptr<const StereoRectifier> rectifier = nullptr);
+    
+    // Takes frames from arbitrary sources, e.g. ReplayFrameSource recordings;
+    // the configs still size the frame pools and the merged view
+    StereoCaptureSystem(std::unique_ptr<FrameSource> leftSource,
+                       std::unique_ptr<FrameSource> rightSource,
+                       const CameraConfig& leftConfig,
+                       const CameraConfig& rightConfig,
+                       std::shared_ptr<const StereoRectifier> rectifier = nullptr);
     ~StereoCaptureSystem();
 
     // Camera operations
     bool captureLeftFrame(cv::Mat& frame);
     bool captureRightFrame(cv::Mat& frame);
-    void updateMergedView(const cv::Mat& frame, bool isLeft);
-    cv::Mat getMergedFrame() const;
+    
+    // Allocation-free capture into a frame taken from the camera's pool,
+    // stamped with a per-camera sequence number and monotonic capture time
+    bool captureLeftFrame(FramePool::Handle& frame);
+    bool captureRightFrame(FramePool::Handle& frame);
+    uint64_t getPoolExhaustions() const;
+    
+    // Triggered capture: grabPair() grabs both cameras back to back from one
+    // trigger point; retrieveLeftFrame() and retrieveRightFrame() then decode
+    // the grabbed frames into pooled frames and may run in parallel, one per
+    // camera task. Frames are stamped with their grab times, so a pair's
+    // skew is the time between the two grabs, not between the tasks' phases.
+    //
+    // The right camera is grabbed by the grabbing task and retrieved by
+    // another, so grabPair() skips the trigger (returns false and counts it)
+    // until that pair's right frame was retrieved or given up with
+    // skipRightFrame(). The right camera is never used from two tasks at once.
+    bool grabPair();
+    bool retrieveLeftFrame(FramePool::Handle& frame);
+    bool retrieveRightFrame(FramePool::Handle& frame);
+    void skipRightFrame();
+    
+    // Time from the left to the right grab of triggered pairs, and the
+    // triggers skipped while a right retrieve was pending
+    struct GrabStats {
+        uint64_t pairs;
+        std::chrono::nanoseconds lastSkew;
+        std::chrono::nanoseconds maxSkew;
+        uint64_t skippedTriggers;
+    };
+    GrabStats getGrabStats() const;
+    
+    // Size of the frames handed out: the camera's, or the rectifier output
+    cv::Size frameSize(bool isLeft) const { return isLeft ? leftSize_ : rightSize_; }
+    
+    // OpenCV type of the frames handed out: CV_8UC2 for packed YUYV
+    int frameType() const { return frameType_; }
+    
+    // Merged side-by-side view. A single writer fills the halves and a
+    // single reader picks up the newest complete view without copying; the
+    // returned Mat shares the reader's buffer and stays valid until the next
+    // getMergedFrame() call. The view holds clean pixels; annotate it with a
+    // StereoOverlay only where it is displayed or recorded. Packed frames
+    // are assembled packed and converted to BGR by the reader.
+    bool updateMergedView(const cv::Mat& frame, bool isLeft);
+    cv::Mat getMergedFrame();
     void stop();
 
     // Xenomai tasks
@@ -44,11 +112,46 @@ private:
     void captureThread(const CameraConfig& config, bool isLeft);
     void setCPUAffinity(int cpuCore);
     void monitorPerformance(const std::string& cameraId);
+    bool readFrame(bool isLeft, cv::Mat& frame, std::chrono::nanoseconds& timestamp);
+    bool retrieveFrame(bool isLeft, FramePool::Handle& frame);
+    void rectifyRaw(bool isLeft, cv::Mat& frame);
 
-    std::unique_ptr<cv::VideoCapture> leftCam_;
-    std::unique_ptr<cv::VideoCapture> rightCam_;
+    std::unique_ptr<FrameSource> leftCam_;
+    std::unique_ptr<FrameSource> rightCam_;
+    
+    // Raw frames are read into these before rectification, by way of the
+    // BGR ones when the cameras deliver YUYV
+    std::shared_ptr<const StereoRectifier> rectifier_;
+    cv::Mat leftRaw_;
+    cv::Mat rightRaw_;
+    cv::Mat leftBgr_;
+    cv::Mat rightBgr_;
+    cv::Size leftSize_;
+    cv::Size rightSize_;
+    int frameType_;
+    
+    FramePool leftPool_;
+    FramePool rightPool_;
+    uint64_t leftSequence_{0};
+    uint64_t rightSequence_{0};
+    
+    // Grab times of the latched pair, each read by its eye's retrieve; the
+    // statistics are written by grabPair() only
+    std::chrono::nanoseconds leftGrabTime_{0};
+    std::chrono::nanoseconds rightGrabTime_{0};
+    std::atomic<uint64_t> grabbedPairs_{0};
+    std::atomic<int64_t> lastGrabSkew_{0};
+    std::atomic<int64_t> maxGrabSkew_{0};
+    // Set by grabPair(), cleared once the right task is done with the pair
+    std::atomic<bool> rightPending_{false};
+    std::atomic<uint64_t> skippedTriggers_{0};
     
-    cv::Mat mergedFrame_;  // Stores the side-by-side view
+    // Stores the side-by-side view
+    static constexpr uint8_t kLeftHalf = 0x1;
+    static constexpr uint8_t kRightHalf = 0x2;
+    TripleBuffer<cv::Mat> mergedView_;
+    uint8_t pendingHalves_{0};
+    cv::Mat convertedView_;  // reader's BGR copy of a packed view
     
     CameraConfig leftConfig_;
     CameraConfig rightConfig_;
@@ -0,0 +1,61 @@
+#include "stereo_overlay.hpp"
+#include <stdexcept>
+
+namespace rt {
+
+namespace {
+
+const cv::Scalar kOverlayColor(0, 255, 0);
+const int kFont = cv::FONT_HERSHEY_SIMPLEX;
+const double kFontScale = 1.0;
+const int kThickness = 2;
+const cv::Point kLabelOffset(10, 8);  // Top-left of the label within each eye
+
+} // namespace
+
+StereoOverlay::StereoOverlay(int eyeWidth, int height)
+    : eyeWidth_(eyeWidth)
+    , height_(height)
+    , leftLabel_(renderLabel("Left Camera"))
+    , rightLabel_(renderLabel("Right Camera")) {
+    if (eyeWidth <= 0 || height <= 0) {
+        throw std::invalid_argument("Overlay needs a positive eye size");
+    }
+}
+
+cv::Mat StereoOverlay::renderLabel(const std::string& text) {
+    int baseline = 0;
+    cv::Size size = cv::getTextSize(text, kFont, kFontScale, kThickness, &baseline);
+
+    // Mask covers the glyphs from the top of the text to below the baseline
+    cv::Mat mask = cv::Mat::zeros(size.height + baseline + kThickness, size.width + kThickness,
+                                  CV_8UC1);
+    cv::putText(mask, text, cv::Point(0, size.height), kFont, kFontScale,
+                cv::Scalar(255), kThickness);
+    return mask;
+}
+
+void StereoOverlay::apply(cv::Mat& view) const {
+    if (view.empty() || view.cols < eyeWidth_ || view.rows < height_) {
+        return;
+    }
+
+    cv::line(view,
+             cv::Point(eyeWidth_, 0),
+             cv::Point(eyeWidth_, height_),
+             kOverlayColor, kThickness);
+
+    auto stamp = [&view](const cv::Mat& label, int eyeOffset) {
+        cv::Rect target(eyeOffset + kLabelOffset.x, kLabelOffset.y, label.cols, label.rows);
+        cv::Rect clipped = target & cv::Rect(0, 0, view.cols, view.rows);
+        if (clipped.area() > 0) {
+            cv::Rect source(clipped.x - target.x, clipped.y - target.y,
+                            clipped.width, clipped.height);
+            view(clipped).setTo(kOverlayColor, label(source));
+        }
+    };
+    stamp(leftLabel_, 0);
+    stamp(rightLabel_, eyeWidth_);
+}
+
+} // namespace rt
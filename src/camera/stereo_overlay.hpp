@@ -0,0 +1,29 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace rt {
+
+// Annotation layer for the side-by-side view: eye separator and camera
+// labels. It is applied lazily by whoever displays or records a view, so
+// the capture path and the detector only ever see clean pixels.
+//
+// Label text is rasterized once at construction into small masks; applying
+// the overlay is then a line and two masked fills.
+class StereoOverlay {
+public:
+    StereoOverlay(int eyeWidth, int height);
+
+    // Draws onto a view the caller owns, e.g. the reader's merged frame
+    void apply(cv::Mat& view) const;
+
+private:
+    static cv::Mat renderLabel(const std::string& text);
+
+    int eyeWidth_;
+    int height_;
+    cv::Mat leftLabel_;
+    cv::Mat rightLabel_;
+};
+
+} // namespace rt
@@ -0,0 +1,216 @@
+#include "stereo_rectifier.hpp"
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgproc.hpp>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace rt {
+
+namespace {
+
+constexpr uint32_t kCacheMagic = 0x4d525452;  // "RTRM"
+constexpr uint32_t kCacheVersion = 1;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t inputWidth;
+    int32_t inputHeight;
+    int32_t outputWidth;
+    int32_t outputHeight;
+    uint64_t fingerprint;
+    uint64_t elements;
+};
+
+// FNV-1a over everything the tables are built from
+class Fingerprint {
+public:
+    void add(const void* data, size_t bytes) {
+        const auto* byte = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < bytes; ++i) {
+            hash_ = (hash_ ^ byte[i]) * 1099511628211ull;
+        }
+    }
+
+    template <typename T, int m, int n>
+    void add(const cv::Matx<T, m, n>& matrix) { add(matrix.val, sizeof(matrix.val)); }
+
+    void add(const cv::Mat& matrix) {
+        cv::Mat values;
+        matrix.convertTo(values, CV_64F);
+        add(values.ptr(), values.total() * values.elemSize());
+    }
+
+    uint64_t value() const { return hash_; }
+
+private:
+    uint64_t hash_{14695981039346656037ull};
+};
+
+uint64_t fingerprintOf(const StereoCalibration& calibration, const cv::Size& outputSize) {
+    Fingerprint fingerprint;
+    for (StereoEye eye : {StereoEye::Left, StereoEye::Right}) {
+        const StereoCalibration::View& view = calibration.view(eye);
+        fingerprint.add(view.camera.matrix);
+        fingerprint.add(view.camera.distortion);
+        fingerprint.add(view.rotation);
+        fingerprint.add(view.projection);
+    }
+    const int sizes[] = {calibration.imageSize().width, calibration.imageSize().height,
+                         outputSize.width, outputSize.height};
+    fingerprint.add(sizes, sizeof(sizes));
+    return fingerprint.value();
+}
+
+} // namespace
+
+StereoRectifier::StereoRectifier(const StereoCalibration& calibration, const cv::Size& outputSize)
+    : StereoRectifier(calibration, outputSize, true) {
+}
+
+StereoRectifier::StereoRectifier(const StereoCalibration& calibration, const cv::Size& outputSize,
+                                 bool build)
+    : calibration_(calibration)
+    , outputSize_(outputSize)
+    , scaleX_(static_cast<double>(outputSize.width) / calibration.imageSize().width)
+    , scaleY_(static_cast<double>(outputSize.height) / calibration.imageSize().height)
+    , fingerprint_(fingerprintOf(calibration, outputSize)) {
+    if (outputSize.width <= 0 || outputSize.height <= 0) {
+        throw std::invalid_argument("Rectified output size must be positive");
+    }
+    layoutTables();
+    if (!build) {
+        return;
+    }
+
+    for (StereoEye eye : {StereoEye::Left, StereoEye::Right}) {
+        // Scaling the rectified projection (about pixel centres) makes the
+        // same lookup resize to the output
+        const cv::Matx34d& projection = calibration_.view(eye).projection;
+        const cv::Matx33d scaled(
+            projection(0, 0) * scaleX_, projection(0, 1) * scaleX_,
+            (projection(0, 2) + 0.5) * scaleX_ - 0.5,
+            projection(1, 0) * scaleY_, projection(1, 1) * scaleY_,
+            (projection(1, 2) + 0.5) * scaleY_ - 0.5,
+            0.0, 0.0, 1.0);
+        const StereoCalibration::View& view = calibration_.view(eye);
+        cv::Mat positions, weights;
+        cv::initUndistortRectifyMap(view.camera.matrix, view.camera.distortion, view.rotation,
+                                    scaled, outputSize_, CV_16SC2, positions, weights);
+
+        // Into the shared storage; the headers already have the right shape
+        const Tables& target = tables(eye);
+        cv::Mat targetPositions = target.positions;
+        cv::Mat targetWeights = target.weights;
+        positions.copyTo(targetPositions);
+        weights.copyTo(targetWeights);
+    }
+}
+
+void StereoRectifier::layoutTables() {
+    // Per eye and pixel: two int16 positions and one uint16 weight index
+    const size_t pixels = static_cast<size_t>(outputSize_.area());
+    storage_.assign(2 * 3 * pixels, 0);
+    for (int eye = 0; eye < 2; ++eye) {
+        int16_t* base = storage_.data() + eye * 3 * pixels;
+        tables_[eye].positions = cv::Mat(outputSize_, CV_16SC2, base);
+        tables_[eye].weights = cv::Mat(outputSize_, CV_16UC1, base + 2 * pixels);
+    }
+}
+
+std::shared_ptr<const StereoRectifier> StereoRectifier::create(
+    const StereoCalibration& calibration, const cv::Size& outputSize,
+    const std::string& cachePath) {
+    std::shared_ptr<StereoRectifier> cached(new StereoRectifier(calibration, outputSize, false));
+    if (cached->loadTables(cachePath)) {
+        spdlog::info("Loaded rectification tables from {}", cachePath);
+        return cached;
+    }
+
+    std::shared_ptr<StereoRectifier> built(new StereoRectifier(calibration, outputSize, true));
+    if (!built->save(cachePath)) {
+        spdlog::warn("Could not cache rectification tables at {}", cachePath);
+    }
+    return built;
+}
+
+bool StereoRectifier::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    const CacheHeader header{kCacheMagic, kCacheVersion,
+                             inputSize().width, inputSize().height,
+                             outputSize_.width, outputSize_.height,
+                             fingerprint_, storage_.size()};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(storage_.data()),
+              static_cast<std::streamsize>(storage_.size() * sizeof(int16_t)));
+    return static_cast<bool>(out);
+}
+
+bool StereoRectifier::loadTables(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    CacheHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != kCacheMagic || header.version != kCacheVersion ||
+        header.inputWidth != inputSize().width || header.inputHeight != inputSize().height ||
+        header.outputWidth != outputSize_.width || header.outputHeight != outputSize_.height ||
+        header.fingerprint != fingerprint_ || header.elements != storage_.size()) {
+        return false;
+    }
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(storage_.data()),
+                                     static_cast<std::streamsize>(storage_.size() * sizeof(int16_t))));
+}
+
+void StereoRectifier::rectify(StereoEye eye, const cv::Mat& raw, cv::Mat& rectified) const {
+    rectify(eye, raw, cv::Rect(cv::Point(), outputSize_), rectified);
+}
+
+void StereoRectifier::rectify(StereoEye eye, const cv::Mat& raw, const cv::Rect& roi,
+                              cv::Mat& rectified) const {
+    if (raw.size() != inputSize()) {
+        throw std::invalid_argument("Frame does not match the calibrated image size");
+    }
+    const Tables& table = tables(eye);
+    cv::remap(raw, rectified, table.positions(roi), table.weights(roi), cv::INTER_LINEAR,
+              cv::BORDER_CONSTANT);
+}
+
+cv::Rect StereoRectifier::rectifyBox(StereoEye eye, const cv::Rect& box) const {
+    const cv::Rect rectified = calibration_.rectify(calibration_.view(eye), box);
+    const cv::Point topLeft(static_cast<int>(std::floor(rectified.x * scaleX_)),
+                            static_cast<int>(std::floor(rectified.y * scaleY_)));
+    const cv::Point bottomRight(static_cast<int>(std::ceil(rectified.br().x * scaleX_)),
+                                static_cast<int>(std::ceil(rectified.br().y * scaleY_)));
+    return cv::Rect(topLeft, bottomRight) & cv::Rect(cv::Point(), outputSize_);
+}
+
+cv::Rect StereoRectifier::unrectifyBox(StereoEye eye, const cv::Rect& box) const {
+    const cv::Rect clamped = box & cv::Rect(cv::Point(), outputSize_);
+    if (clamped.empty()) {
+        return cv::Rect();
+    }
+
+    // Corners and edge midpoints, as lens distortion bends the edges
+    const int xs[] = {clamped.x, clamped.x + clamped.width / 2, clamped.x + clamped.width - 1};
+    const int ys[] = {clamped.y, clamped.y + clamped.height / 2, clamped.y + clamped.height - 1};
+    const cv::Mat& positions = tables(eye).positions;
+    cv::Point topLeft(inputSize().width, inputSize().height);
+    cv::Point bottomRight(0, 0);
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col) {
+            if (row == 1 && col == 1) {
+                continue;
+            }
+            const cv::Vec2s source = positions.at<cv::Vec2s>(ys[row], xs[col]);
+            topLeft.x = std::min(topLeft.x, static_cast<int>(source[0]));
+            topLeft.y = std::min(topLeft.y, static_cast<int>(source[1]));
+            bottomRight.x = std::max(bottomRight.x, source[0] + 1);
+            bottomRight.y = std::max(bottomRight.y, source[1] + 1);
+        }
+    }
+    return cv::Rect(topLeft, bottomRight) & cv::Rect(cv::Point(), inputSize());
+}
+
+} // namespace rt
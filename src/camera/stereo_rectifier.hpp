@@ -0,0 +1,88 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "stereo_calibration.hpp"
+
+namespace rt {
+
+// Rectifies both eyes of a calibrated rig with remap tables built once.
+//
+// Tables are in OpenCV's fixed-point form: per output pixel, the integer
+// source position (CV_16SC2) and an index into the 32x32 bilinear weight
+// grid (CV_16UC1), which cv::remap applies with its vectorized 8-bit path.
+// Both eyes' tables share one allocation, so they can be cached to disk
+// and read back with a single read instead of rebuilt from the
+// calibration at every start.
+//
+// An output smaller than the calibrated image size fuses the downscale
+// into the same lookup: the rectified projection is scaled, so one remap
+// both rectifies and resizes. Rectified focal lengths and boxes are then
+// in output pixels.
+class StereoRectifier {
+public:
+    StereoRectifier(const StereoCalibration& calibration, const cv::Size& outputSize);
+
+    StereoRectifier(const StereoRectifier&) = delete;
+    StereoRectifier& operator=(const StereoRectifier&) = delete;
+
+    // Reads the tables from cachePath when they were built for this
+    // calibration and output size; otherwise builds them and refreshes the
+    // cache. A cache that cannot be written only costs the next start.
+    static std::shared_ptr<const StereoRectifier> create(const StereoCalibration& calibration,
+                                                         const cv::Size& outputSize,
+                                                         const std::string& cachePath);
+
+    // Writes the tables with a header identifying calibration and size
+    bool save(const std::string& path) const;
+
+    // Rectifies a raw frame of inputSize() into outputSize() pixels. Safe
+    // to call for both eyes from different threads.
+    void rectify(StereoEye eye, const cv::Mat& raw, cv::Mat& rectified) const;
+
+    // Rectifies only roi, given in output pixels
+    void rectify(StereoEye eye, const cv::Mat& raw, const cv::Rect& roi, cv::Mat& rectified) const;
+
+    // Bounding box in output pixels of a box in raw pixels
+    cv::Rect rectifyBox(StereoEye eye, const cv::Rect& box) const;
+
+    // Bounding box in raw pixels of a box in output pixels, read from the
+    // tables (to whole pixels)
+    cv::Rect unrectifyBox(StereoEye eye, const cv::Rect& box) const;
+
+    const cv::Size& inputSize() const { return calibration_.imageSize(); }
+    const cv::Size& outputSize() const { return outputSize_; }
+    const StereoCalibration& calibration() const { return calibration_; }
+
+    // Rectified focal length in output pixels; disparities measured on
+    // rectified frames convert to distance with it
+    double focalLength() const { return calibration_.focalLength() * scaleX_; }
+    double distance(double disparity) const {
+        return focalLength() * calibration_.baseline() / disparity;
+    }
+
+private:
+    struct Tables {
+        cv::Mat positions;  // CV_16SC2
+        cv::Mat weights;    // CV_16UC1
+    };
+
+    StereoRectifier(const StereoCalibration& calibration, const cv::Size& outputSize,
+                    bool build);
+    void layoutTables();
+    bool loadTables(const std::string& path);
+    const Tables& tables(StereoEye eye) const { return tables_[eye == StereoEye::Left ? 0 : 1]; }
+
+    StereoCalibration calibration_;
+    cv::Size outputSize_;
+    double scaleX_;
+    double scaleY_;
+    uint64_t fingerprint_;
+    std::vector<int16_t> storage_;  // both eyes' tables, back to back
+    Tables tables_[2];
+};
+
+} // namespace rt
@@ -0,0 +1,121 @@
+#include "stereo_synchronizer.hpp"
+#include <stdexcept>
+
+namespace rt {
+
+void StereoSynchronizer::PendingFrames::push(FramePool::Handle frame) {
+    frames[(head + count) % kMaxPending] = std::move(frame);
+    ++count;
+}
+
+void StereoSynchronizer::PendingFrames::dropFront() {
+    frames[head].reset();
+    head = (head + 1) % kMaxPending;
+    --count;
+}
+
+StereoSynchronizer::StereoSynchronizer(const Config& config)
+    : config_(config) {
+    if (config.maxSkew.count() < 0) {
+        throw std::invalid_argument("Stereo skew window must not be negative");
+    }
+}
+
+void StereoSynchronizer::pushLeft(FramePool::Handle frame) {
+    push(left_, std::move(frame), droppedLeft_);
+}
+
+void StereoSynchronizer::pushRight(FramePool::Handle frame) {
+    push(right_, std::move(frame), droppedRight_);
+}
+
+void StereoSynchronizer::push(PendingFrames& pending, FramePool::Handle frame,
+                              std::atomic<uint64_t>& dropped) {
+    if (!frame) {
+        return;
+    }
+
+    // The other eye fell too far behind; the oldest frame cannot be paired
+    if (pending.count == kMaxPending) {
+        pending.dropFront();
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    pending.push(std::move(frame));
+}
+
+bool StereoSynchronizer::tryMatch(StereoPair& pair) {
+    if (!matchOldest(pair)) {
+        return false;
+    }
+    recordMatch(pair);
+    return true;
+}
+
+bool StereoSynchronizer::tryMatchNewest(StereoPair& pair) {
+    if (!matchOldest(pair)) {
+        return false;
+    }
+    while (matchOldest(pair)) {
+        skippedPairs_.fetch_add(1, std::memory_order_relaxed);
+    }
+    recordMatch(pair);
+    return true;
+}
+
+bool StereoSynchronizer::matchOldest(StereoPair& pair) {
+    while (left_.count > 0 && right_.count > 0) {
+        const auto skew = left_.front().timestamp() - right_.front().timestamp();
+
+        if (skew > config_.maxSkew) {
+            // Right frame is older than anything the left eye can still offer
+            right_.dropFront();
+            droppedRight_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        if (-skew > config_.maxSkew) {
+            left_.dropFront();
+            droppedLeft_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        pair.left = std::move(left_.front());
+        pair.right = std::move(right_.front());
+        pair.skew = skew;
+        left_.dropFront();
+        right_.dropFront();
+        return true;
+    }
+    return false;
+}
+
+void StereoSynchronizer::recordMatch(const StereoPair& pair) {
+    const int64_t skew = pair.skew.count();
+    const int64_t skewNs = skew < 0 ? -skew : skew;
+    lastSkewNs_.store(skew, std::memory_order_relaxed);
+    if (skewNs > maxSkewNs_.load(std::memory_order_relaxed)) {
+        maxSkewNs_.store(skewNs, std::memory_order_relaxed);
+    }
+    matchedPairs_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void StereoSynchronizer::clear() {
+    while (left_.count > 0) {
+        left_.dropFront();
+    }
+    while (right_.count > 0) {
+        right_.dropFront();
+    }
+}
+
+StereoSynchronizer::Stats StereoSynchronizer::getStats() const {
+    Stats stats;
+    stats.matchedPairs = matchedPairs_.load(std::memory_order_relaxed);
+    stats.skippedPairs = skippedPairs_.load(std::memory_order_relaxed);
+    stats.droppedLeft = droppedLeft_.load(std::memory_order_relaxed);
+    stats.droppedRight = droppedRight_.load(std::memory_order_relaxed);
+    stats.lastSkew = std::chrono::nanoseconds(lastSkewNs_.load(std::memory_order_relaxed));
+    stats.maxSkew = std::chrono::nanoseconds(maxSkewNs_.load(std::memory_order_relaxed));
+    return stats;
+}
+
+} // namespace rt
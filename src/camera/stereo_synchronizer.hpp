@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "frame_pool.hpp"
+
+namespace rt {
+
+// Pairs left and right frames by capture timestamp. Frames whose partner
+// falls outside the skew window are dropped as stragglers and counted, so
+// downstream stereo stages only ever see frames from the same instant.
+//
+// Pushing and matching must happen on one thread (the pairing stage);
+// getStats() may be called from any thread.
+class StereoSynchronizer {
+public:
+    struct Config {
+        std::chrono::nanoseconds maxSkew;
+    };
+
+    struct StereoPair {
+        FramePool::Handle left;
+        FramePool::Handle right;
+        std::chrono::nanoseconds skew{0};  // left minus right capture time
+    };
+
+    struct Stats {
+        uint64_t matchedPairs{0};
+        uint64_t skippedPairs{0};  // matched, but superseded by a newer pair
+        uint64_t droppedLeft{0};
+        uint64_t droppedRight{0};
+        std::chrono::nanoseconds lastSkew{0};
+        std::chrono::nanoseconds maxSkew{0};
+    };
+
+    // Frames buffered per eye while waiting for a partner
+    static constexpr std::size_t kMaxPending = 4;
+
+    explicit StereoSynchronizer(const Config& config);
+
+    void pushLeft(FramePool::Handle frame);
+    void pushRight(FramePool::Handle frame);
+
+    // Emits the oldest matched pair, dropping stragglers on the way.
+    // Returns false once one eye has no pending frames left.
+    bool tryMatch(StereoPair& pair);
+
+    // Emits only the newest matched pair; the older ones go back to their
+    // pools and count as skipped, not matched
+    bool tryMatchNewest(StereoPair& pair);
+
+    // Returns every pending frame to its pool; statistics are kept
+    void clear();
+
+    Stats getStats() const;
+
+private:
+    struct PendingFrames {
+        std::array<FramePool::Handle, kMaxPending> frames;
+        std::size_t head = 0;
+        std::size_t count = 0;
+
+        FramePool::Handle& front() { return frames[head]; }
+        void push(FramePool::Handle frame);
+        void dropFront();
+    };
+
+    void push(PendingFrames& pending, FramePool::Handle frame,
+              std::atomic<uint64_t>& dropped);
+    bool matchOldest(StereoPair& pair);
+    void recordMatch(const StereoPair& pair);
+
+    Config config_;
+    PendingFrames left_;
+    PendingFrames right_;
+
+    std::atomic<uint64_t> matchedPairs_{0};
+    std::atomic<uint64_t> skippedPairs_{0};
+    std::atomic<uint64_t> droppedLeft_{0};
+    std::atomic<uint64_t> droppedRight_{0};
+    std::atomic<int64_t> lastSkewNs_{0};
+    std::atomic<int64_t> maxSkewNs_{0};
+};
+
+} // namespace rt
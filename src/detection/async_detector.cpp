@@ -0,0 +1,57 @@
+#include "async_detector.hpp"
+#include <stdexcept>
+
+namespace rt {
+
+AsyncDetector::AsyncDetector(YOLODetector& detector, size_t maxDetections)
+    : detector_(detector)
+    , results_(static_cast<size_t>(detector.inputBatchSize())) {
+    if (results_.empty()) {
+        throw std::logic_error("AsyncDetector needs the detector inputs reserved first");
+    }
+    for (auto& image : results_) {
+        image.reserve(maxDetections);
+    }
+}
+
+bool AsyncDetector::submit(size_t slot, int count) {
+    if (slot >= detector_.inputCount() || count <= 0 || count > detector_.inputBatchSize()) {
+        // Fail here rather than on the worker, where nobody could catch it
+        throw std::out_of_range("Async detector request does not fit the reserved inputs");
+    }
+    if (state_.load(std::memory_order_acquire) != Idle) {
+        return false;
+    }
+
+    slot_ = slot;
+    count_ = count;
+    state_.store(Submitted, std::memory_order_release);
+    return true;
+}
+
+bool AsyncDetector::runPending() {
+    if (state_.load(std::memory_order_acquire) != Submitted) {
+        return false;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    detector_.detectBatch(slot_, count_, results_.data());
+    runTime_ = std::chrono::steady_clock::now() - start;
+    state_.store(Done, std::memory_order_release);
+    return true;
+}
+
+bool AsyncDetector::poll(std::vector<YOLODetector::DetectionResult>* results) {
+    if (state_.load(std::memory_order_acquire) != Done) {
+        return false;
+    }
+
+    // The caller's vectors become next request's scratch
+    for (int image = 0; image < count_; ++image) {
+        results[image].swap(results_[image]);
+    }
+    state_.store(Idle, std::memory_order_release);
+    return true;
+}
+
+} // namespace rt
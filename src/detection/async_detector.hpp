@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include "yolo_detector.hpp"
+
+namespace rt {
+
+// Runs YOLODetector::detectBatch() on a worker so the caller never blocks
+// on a forward pass.
+//
+// One request is in flight at a time. The scheduling side submit()s a
+// detector input slot and later poll()s for its results; the worker side
+// calls runPending() whenever it is woken. The input slot must stay
+// untouched until poll() has returned it, while the producer fills the
+// next slot, so the detector's input tensors act as a double buffer.
+//
+// All hand-over goes through one atomic state word, and results are
+// swapped out rather than copied, so neither side locks or allocates.
+class AsyncDetector {
+public:
+    // Reserve the detector's inputs first; result storage is sized to
+    // its batch, with room for maxDetections boxes per image
+    AsyncDetector(YOLODetector& detector, size_t maxDetections);
+
+    AsyncDetector(const AsyncDetector&) = delete;
+    AsyncDetector& operator=(const AsyncDetector&) = delete;
+
+    // Scheduler side. Returns false while the previous request is still
+    // in flight or waiting to be polled.
+    bool submit(size_t slot, int count);
+
+    // Scheduler side, never blocks. Returns true once per request, swapping
+    // its detections into results[0 .. count)
+    bool poll(std::vector<YOLODetector::DetectionResult>* results);
+
+    bool busy() const { return state_.load(std::memory_order_acquire) != Idle; }
+    bool ready() const { return state_.load(std::memory_order_acquire) == Done; }
+    size_t slot() const { return slot_; }
+    int count() const { return count_; }
+
+    // How long the worker spent on the last request; valid once ready()
+    std::chrono::nanoseconds runTime() const { return runTime_; }
+
+    // Worker side: runs the submitted request, if there is one
+    bool runPending();
+
+private:
+    enum State : int { Idle, Submitted, Done };
+
+    YOLODetector& detector_;
+    std::vector<std::vector<YOLODetector::DetectionResult>> results_;
+
+    // Written by submit() before the state is released to the worker
+    size_t slot_{0};
+    int count_{0};
+
+    // Written by runPending() before the state is released back
+    std::chrono::nanoseconds runTime_{0};
+
+    alignas(64) std::atomic<int> state_{Idle};
+};
+
+} // namespace rt
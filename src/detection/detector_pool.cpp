@@ -0,0 +1,57 @@
+#include "detector_pool.hpp"
+#include <stdexcept>
+
+namespace rt {
+
+DetectorPool::DetectorPool(const YOLODetector::Config& config, size_t size)
+    : model_(YoloModel::load(config.modelPath, config.configPath, config.classesPath)) {
+    if (size == 0) {
+        throw std::invalid_argument("Detector pool needs at least one detector");
+    }
+
+    entries_.reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        entries_.push_back(std::make_unique<Entry>());
+        entries_.back()->detector = std::make_unique<YOLODetector>(config, model_);
+    }
+}
+
+YOLODetector& DetectorPool::forWorker(size_t worker) {
+    return *entries_[worker % entries_.size()]->detector;
+}
+
+DetectorPool::Lease DetectorPool::tryAcquire() {
+    // Start after the last detector handed out so load spreads evenly
+    const size_t start = next_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        Entry* entry = entries_[(start + i) % entries_.size()].get();
+        if (!entry->busy.exchange(true, std::memory_order_acquire)) {
+            return Lease(entry);
+        }
+    }
+    return Lease();
+}
+
+DetectorPool::Lease::Lease(Lease&& other) noexcept
+    : entry_(other.entry_) {
+    other.entry_ = nullptr;
+}
+
+DetectorPool::Lease& DetectorPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        if (entry_) {
+            entry_->busy.store(false, std::memory_order_release);
+        }
+        entry_ = other.entry_;
+        other.entry_ = nullptr;
+    }
+    return *this;
+}
+
+DetectorPool::Lease::~Lease() {
+    if (entry_) {
+        entry_->busy.store(false, std::memory_order_release);
+    }
+}
+
+} // namespace rt
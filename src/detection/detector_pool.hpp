@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "yolo_detector.hpp"
+#include "yolo_model.hpp"
+
+namespace rt {
+
+// Several YOLODetectors built from one YoloModel, one per worker thread.
+//
+// A detector keeps per-instance net state and output buffers, so it must
+// only ever run on one thread at a time. The pool offers two ways to
+// guarantee that; use one or the other on a given pool, not both:
+//  - affinity: worker i always uses forWorker(i), e.g. one per pinned core
+//  - round-robin: tryAcquire() leases the next idle detector and gives it
+//    back when the lease goes out of scope
+//
+// The realtime pipeline in main.cpp runs a single detector on its
+// inference task and does not use a pool.
+class DetectorPool {
+    struct Entry {
+        std::unique_ptr<YOLODetector> detector;
+        std::atomic<bool> busy{false};
+    };
+
+public:
+    DetectorPool(const YOLODetector::Config& config, size_t size);
+
+    DetectorPool(const DetectorPool&) = delete;
+    DetectorPool& operator=(const DetectorPool&) = delete;
+
+    size_t size() const { return entries_.size(); }
+    const std::shared_ptr<const YoloModel>& model() const { return model_; }
+
+    YOLODetector& forWorker(size_t worker);
+
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        explicit operator bool() const { return entry_ != nullptr; }
+        YOLODetector* operator->() const { return entry_->detector.get(); }
+        YOLODetector& operator*() const { return *entry_->detector; }
+
+    private:
+        friend class DetectorPool;
+        explicit Lease(Entry* entry) : entry_(entry) {}
+
+        Entry* entry_{nullptr};
+    };
+
+    // Never blocks; the lease is empty when every detector is in use
+    Lease tryAcquire();
+
+private:
+    std::shared_ptr<const YoloModel> model_;
+    std::vector<std::unique_ptr<Entry>> entries_;
+    std::atomic<size_t> next_{0};
+};
+
+} // namespace rt
@@ -0,0 +1,190 @@
+#include "nms.hpp"
+#include <algorithm>
+
+#if RT_HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace rt {
+
+namespace {
+
+// IoU > t  <=>  intersection > t * union, which avoids the division.
+// box holds x0, y0, x1, y1, area.
+bool overlapsScalar(const float* x0, const float* y0, const float* x1, const float* y1,
+                    const float* area, size_t count, const float* box, float iouThreshold) {
+    for (size_t i = 0; i < count; ++i) {
+        const float w = std::max(0.0f, std::min(x1[i], box[2]) - std::max(x0[i], box[0]));
+        const float h = std::max(0.0f, std::min(y1[i], box[3]) - std::max(y0[i], box[1]));
+        const float inter = w * h;
+        if (inter > iouThreshold * (area[i] + box[4] - inter)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if RT_HAVE_X86_SIMD
+
+bool overlapsSSE2(const float* x0, const float* y0, const float* x1, const float* y1,
+                  const float* area, size_t count, const float* box, float iouThreshold) {
+    const __m128 bx0 = _mm_set1_ps(box[0]);
+    const __m128 by0 = _mm_set1_ps(box[1]);
+    const __m128 bx1 = _mm_set1_ps(box[2]);
+    const __m128 by1 = _mm_set1_ps(box[3]);
+    const __m128 barea = _mm_set1_ps(box[4]);
+    const __m128 threshold = _mm_set1_ps(iouThreshold);
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 w = _mm_max_ps(zero, _mm_sub_ps(_mm_min_ps(_mm_loadu_ps(x1 + i), bx1),
+                                                     _mm_max_ps(_mm_loadu_ps(x0 + i), bx0)));
+        const __m128 h = _mm_max_ps(zero, _mm_sub_ps(_mm_min_ps(_mm_loadu_ps(y1 + i), by1),
+                                                     _mm_max_ps(_mm_loadu_ps(y0 + i), by0)));
+        const __m128 inter = _mm_mul_ps(w, h);
+        const __m128 unionArea = _mm_sub_ps(_mm_add_ps(_mm_loadu_ps(area + i), barea), inter);
+        if (_mm_movemask_ps(_mm_cmpgt_ps(inter, _mm_mul_ps(threshold, unionArea)))) {
+            return true;
+        }
+    }
+    return overlapsScalar(x0 + i, y0 + i, x1 + i, y1 + i, area + i, count - i, box,
+                          iouThreshold);
+}
+
+RT_TARGET_AVX2
+bool overlapsAVX2(const float* x0, const float* y0, const float* x1, const float* y1,
+                  const float* area, size_t count, const float* box, float iouThreshold) {
+    const __m256 bx0 = _mm256_set1_ps(box[0]);
+    const __m256 by0 = _mm256_set1_ps(box[1]);
+    const __m256 bx1 = _mm256_set1_ps(box[2]);
+    const __m256 by1 = _mm256_set1_ps(box[3]);
+    const __m256 barea = _mm256_set1_ps(box[4]);
+    const __m256 threshold = _mm256_set1_ps(iouThreshold);
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 w = _mm256_max_ps(zero,
+            _mm256_sub_ps(_mm256_min_ps(_mm256_loadu_ps(x1 + i), bx1),
+                          _mm256_max_ps(_mm256_loadu_ps(x0 + i), bx0)));
+        const __m256 h = _mm256_max_ps(zero,
+            _mm256_sub_ps(_mm256_min_ps(_mm256_loadu_ps(y1 + i), by1),
+                          _mm256_max_ps(_mm256_loadu_ps(y0 + i), by0)));
+        const __m256 inter = _mm256_mul_ps(w, h);
+        const __m256 unionArea = _mm256_sub_ps(_mm256_add_ps(_mm256_loadu_ps(area + i), barea),
+                                               inter);
+        const __m256 suppressed = _mm256_cmp_ps(inter, _mm256_mul_ps(threshold, unionArea),
+                                                _CMP_GT_OQ);
+        if (_mm256_movemask_ps(suppressed)) {
+            return true;
+        }
+    }
+    return overlapsScalar(x0 + i, y0 + i, x1 + i, y1 + i, area + i, count - i, box,
+                          iouThreshold);
+}
+
+#endif
+
+} // namespace
+
+NmsEngine::NmsEngine(SimdLevel level)
+    : overlaps_(&overlapsScalar) {
+#if RT_HAVE_X86_SIMD
+    switch (std::min(level, detectSimdLevel())) {
+        case SimdLevel::AVX2:
+            overlaps_ = &overlapsAVX2;
+            break;
+        case SimdLevel::SSE2:
+            overlaps_ = &overlapsSSE2;
+            break;
+        default:
+            break;
+    }
+#else
+    (void)level;
+#endif
+}
+
+void NmsEngine::reserve(size_t capacity) {
+    order_.reserve(capacity);
+    keptX0_.reserve(capacity);
+    keptY0_.reserve(capacity);
+    keptX1_.reserve(capacity);
+    keptY1_.reserve(capacity);
+    keptArea_.reserve(capacity);
+}
+
+void NmsEngine::run(const CandidateBuffer& candidates, float iouThreshold, size_t topK,
+                    std::vector<int>& keep) {
+    keep.clear();
+
+    const int count = static_cast<int>(candidates.size());
+    order_.resize(count);
+    for (int i = 0; i < count; ++i) {
+        order_[i] = i;
+    }
+
+    // One sort groups classes and ranks each class by score; the index
+    // tie-break keeps the result deterministic
+    const int* classId = candidates.classId.data();
+    const float* score = candidates.score.data();
+    std::sort(order_.begin(), order_.end(), [classId, score](int a, int b) {
+        if (classId[a] != classId[b]) {
+            return classId[a] < classId[b];
+        }
+        if (score[a] != score[b]) {
+            return score[a] > score[b];
+        }
+        return a < b;
+    });
+
+    const size_t limit = topK > 0 ? topK : static_cast<size_t>(count);
+    for (int begin = 0; begin < count;) {
+        int end = begin;
+        while (end < count && classId[order_[end]] == classId[order_[begin]]) {
+            ++end;
+        }
+
+        keptX0_.clear();
+        keptY0_.clear();
+        keptX1_.clear();
+        keptY1_.clear();
+        keptArea_.clear();
+
+        for (int i = begin; i < end && keptArea_.size() < limit; ++i) {
+            const int index = order_[i];
+            const float box[] = {
+                candidates.x0[index], candidates.y0[index],
+                candidates.x1[index], candidates.y1[index],
+                (candidates.x1[index] - candidates.x0[index]) *
+                    (candidates.y1[index] - candidates.y0[index])
+            };
+
+            if (overlaps_(keptX0_.data(), keptY0_.data(), keptX1_.data(), keptY1_.data(),
+                          keptArea_.data(), keptArea_.size(), box, iouThreshold)) {
+                continue;
+            }
+            keptX0_.push_back(box[0]);
+            keptY0_.push_back(box[1]);
+            keptX1_.push_back(box[2]);
+            keptY1_.push_back(box[3]);
+            keptArea_.push_back(box[4]);
+            keep.push_back(index);
+        }
+        begin = end;
+    }
+
+    // Best first across classes, cut to the K best overall
+    auto byScore = [score](int a, int b) {
+        return score[a] != score[b] ? score[a] > score[b] : a < b;
+    };
+    if (keep.size() > limit) {
+        std::partial_sort(keep.begin(), keep.begin() + limit, keep.end(), byScore);
+        keep.resize(limit);
+    } else {
+        std::sort(keep.begin(), keep.end(), byScore);
+    }
+}
+
+} // namespace rt
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "yolo_decoder.hpp"
+#include "../utils/cpu_features.hpp"
+
+namespace rt {
+
+// Class-aware non-maximum suppression over a CandidateBuffer.
+//
+// Candidates are sorted once by class and descending score; each class is
+// then suppressed greedily, testing a candidate against that class's kept
+// boxes several at a time from SoA corner arrays. With topK set, a class
+// stops as soon as it has K boxes, which bounds the quadratic cost in
+// crowded scenes, and only the K best boxes overall are returned.
+//
+// All scratch is sized by reserve(); run() does not allocate as long as
+// the candidate count stays within the reserved capacity.
+class NmsEngine {
+public:
+    explicit NmsEngine(SimdLevel level = detectSimdLevel());
+
+    void reserve(size_t capacity);
+
+    // Writes the indices of the surviving candidates into keep, best score
+    // first. topK == 0 keeps every survivor (plain hard NMS).
+    void run(const CandidateBuffer& candidates, float iouThreshold, size_t topK,
+             std::vector<int>& keep);
+
+    using OverlapFn = bool (*)(const float* x0, const float* y0, const float* x1,
+                               const float* y1, const float* area, size_t count,
+                               const float* box, float iouThreshold);
+
+private:
+    OverlapFn overlaps_;
+
+    std::vector<int> order_;
+
+    // Boxes kept so far for the class being suppressed
+    std::vector<float> keptX0_;
+    std::vector<float> keptY0_;
+    std::vector<float> keptX1_;
+    std::vector<float> keptY1_;
+    std::vector<float> keptArea_;
+};
+
+} // namespace rt
@@ -0,0 +1,59 @@
+#include "resolution_controller.hpp"
+#include <stdexcept>
+
+namespace rt {
+
+ResolutionController::ResolutionController(const Config& config,
+                                           const std::vector<cv::Size>& levels)
+    : config_(config)
+    , level_(levels.empty() ? 0 : levels.size() - 1) {
+    if (levels.empty()) {
+        throw std::invalid_argument("Resolution controller needs at least one level");
+    }
+    if (config.deadline.count() <= 0 || config.smoothing <= 0.0 || config.smoothing > 1.0 ||
+        config.upThreshold >= config.downThreshold) {
+        throw std::invalid_argument("Invalid resolution controller configuration");
+    }
+
+    pixels_.reserve(levels.size());
+    for (const cv::Size& size : levels) {
+        pixels_.push_back(static_cast<double>(size.area()));
+    }
+}
+
+size_t ResolutionController::update(std::chrono::nanoseconds elapsed, size_t measuredLevel) {
+    const double sample = static_cast<double>(elapsed.count()) / pixels_.at(measuredLevel);
+    costPerPixel_ = costPerPixel_ == 0.0
+        ? sample
+        : costPerPixel_ + config_.smoothing * (sample - costPerPixel_);
+
+    const double deadline = static_cast<double>(config_.deadline.count());
+    const double downLimit = config_.downThreshold * deadline;
+
+    if (costPerPixel_ * pixels_[level_] > downLimit) {
+        // Over budget: go as far down as needed at once
+        while (level_ > 0 && costPerPixel_ * pixels_[level_] > downLimit) {
+            --level_;
+        }
+        upStreak_ = 0;
+    } else if (level_ + 1 < pixels_.size() &&
+               costPerPixel_ * pixels_[level_ + 1] <= config_.upThreshold * deadline) {
+        if (++upStreak_ >= config_.upHoldCycles) {
+            ++level_;
+            upStreak_ = 0;
+        }
+    } else {
+        upStreak_ = 0;
+    }
+    return level_;
+}
+
+double ResolutionController::slack() const {
+    return 1.0 - costPerPixel_ * pixels_[level_] / static_cast<double>(config_.deadline.count());
+}
+
+std::chrono::nanoseconds ResolutionController::predictedCost(size_t level) const {
+    return std::chrono::nanoseconds(static_cast<int64_t>(costPerPixel_ * pixels_.at(level)));
+}
+
+} // namespace rt
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include <opencv2/core.hpp>
+
+namespace rt {
+
+// Picks the detector input resolution for the next frame from how much of
+// the deadline the previous detection cycles used.
+//
+// Cycle times are smoothed as cost per input pixel, so samples taken at
+// any level predict the cost at every other level. When the predicted
+// cost of the current level crosses downThreshold of the deadline, the
+// controller drops straight to the largest level that fits; it only
+// steps up one level once that level has been predicted to fit within
+// upThreshold for upHoldCycles cycles in a row. The gap between the two
+// thresholds and the hold keep it from oscillating.
+class ResolutionController {
+public:
+    struct Config {
+        std::chrono::nanoseconds deadline;
+        double downThreshold{0.9};
+        double upThreshold{0.6};
+        int upHoldCycles{10};
+        double smoothing{0.25};  // weight of the newest sample
+    };
+
+    // levels are the detector resolutions, ascending; starts at the top
+    ResolutionController(const Config& config, const std::vector<cv::Size>& levels);
+
+    // Records how long a cycle at measuredLevel took and returns the level
+    // to use next. Pass the level the timed input actually ran at: with
+    // inputs in flight it can lag the current one.
+    size_t update(std::chrono::nanoseconds elapsed, size_t measuredLevel);
+
+    size_t level() const { return level_; }
+
+    // Share of the deadline left at the current level, as predicted from
+    // the smoothed cost; negative when it is expected to be missed
+    double slack() const;
+
+    std::chrono::nanoseconds predictedCost(size_t level) const;
+
+private:
+    Config config_;
+    std::vector<double> pixels_;
+    size_t level_;
+    double costPerPixel_{0.0};  // ns, smoothed
+    int upStreak_{0};
+};
+
+} // namespace rt
@@ -0,0 +1,216 @@
+#include "roi_inference.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace rt {
+
+namespace {
+
+// Whether a detection in network pixels came from the region's cell
+bool inCell(const RegionInput& region, const cv::Rect& box) {
+    return region.cell.empty() ||
+           region.cell.contains(cv::Point(box.x + box.width / 2, box.y + box.height / 2));
+}
+
+cv::Rect mapToFrame(const RegionInput& region, const cv::Rect& box) {
+    const cv::Rect local = region.transform.toSource(box);
+    return cv::Rect(local.x + region.roi.x, local.y + region.roi.y, local.width, local.height);
+}
+
+// Tiles of extent tile needed to cover length with the given overlap
+int tilesAlong(int length, int tile, int overlap) {
+    if (length <= tile) {
+        return 1;
+    }
+    const int stride = tile - overlap;
+    return (length - overlap + stride - 1) / stride;
+}
+
+// Extent of each of count tiles covering length and overlapping by at
+// least overlap, never smaller than tile
+int tileExtent(int length, int tile, int overlap, int count) {
+    const int needed = (length + (count - 1) * overlap + count - 1) / count;
+    return std::min(length, std::max(tile, needed));
+}
+
+// Spreads count tiles evenly, first at 0 and last flush with the end
+int tileOffset(int length, int extent, int count, int index) {
+    return count == 1 ? 0 : static_cast<int>(
+        static_cast<long long>(length - extent) * index / (count - 1));
+}
+
+} // namespace
+
+void planMosaic(const cv::Size& inputSize, int count, std::vector<cv::Rect>& cells) {
+    if (count <= 0 || inputSize.width < count || inputSize.height < count) {
+        throw std::invalid_argument("Invalid mosaic size");
+    }
+
+    const int cols = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    const int rows = (count + cols - 1) / cols;
+    cells.clear();
+    for (int row = 0; row < rows; ++row) {
+        const int inRow = std::min(cols, count - row * cols);
+        const int top = inputSize.height * row / rows;
+        const int bottom = inputSize.height * (row + 1) / rows;
+        for (int col = 0; col < inRow; ++col) {
+            const int left = inputSize.width * col / inRow;
+            const int right = inputSize.width * (col + 1) / inRow;
+            cells.emplace_back(left, top, right - left, bottom - top);
+        }
+    }
+}
+
+RoiPlanner::RoiPlanner(const Config& config)
+    : config_(config)
+    , sinceFullFrame_(config.fullFrameInterval) {  // Start with a full pass
+    if (config.padding < 0.0f || config.minSize <= 0 || config.maxRegions == 0 ||
+        config.maxCoverage <= 0.0f || config.fullFrameInterval <= 0) {
+        throw std::invalid_argument("Invalid ROI planner configuration");
+    }
+    work_.reserve(config.maxKnown);
+}
+
+bool RoiPlanner::plan(const std::vector<cv::Rect>& known, const cv::Size& frameSize,
+                      std::vector<cv::Rect>& regions) {
+    regions.clear();
+    if (known.empty() || ++sinceFullFrame_ >= config_.fullFrameInterval) {
+        sinceFullFrame_ = 0;
+        return false;
+    }
+
+    const cv::Rect frame(cv::Point(), frameSize);
+    work_.clear();
+    for (const cv::Rect& box : known) {
+        const int pad = static_cast<int>(config_.padding * std::max(box.width, box.height));
+        const int width = std::max(box.width + 2 * pad, config_.minSize);
+        const int height = std::max(box.height + 2 * pad, config_.minSize);
+        const cv::Rect crop = cv::Rect(box.x + box.width / 2 - width / 2,
+                                       box.y + box.height / 2 - height / 2, width, height) & frame;
+        if (!crop.empty()) {
+            work_.push_back(crop);
+        }
+    }
+
+    // Merge overlapping crops until none overlap; an object split across
+    // two crops would otherwise be detected twice, each time cut off
+    for (bool merged = true; merged;) {
+        merged = false;
+        for (size_t i = 0; i < work_.size() && !merged; ++i) {
+            for (size_t j = i + 1; j < work_.size(); ++j) {
+                if (!(work_[i] & work_[j]).empty()) {
+                    work_[i] |= work_[j];
+                    work_[j] = work_.back();
+                    work_.pop_back();
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    long long covered = 0;
+    for (const cv::Rect& crop : work_) {
+        covered += crop.area();
+    }
+    if (work_.empty() || work_.size() > config_.maxRegions ||
+        covered > config_.maxCoverage * frame.area()) {
+        sinceFullFrame_ = 0;
+        return false;
+    }
+
+    regions.assign(work_.begin(), work_.end());
+    return true;
+}
+
+TilePlanner::TilePlanner(const Config& config)
+    : config_(config) {
+    if (config.overlap < 0 || config.maxTiles == 0) {
+        throw std::invalid_argument("Invalid tile planner configuration");
+    }
+}
+
+void TilePlanner::plan(const cv::Size& frameSize, const cv::Size& tileSize,
+                       std::vector<cv::Rect>& tiles) const {
+    if (tileSize.width <= config_.overlap || tileSize.height <= config_.overlap) {
+        throw std::invalid_argument("Tiles must be larger than their overlap");
+    }
+
+    int cols = tilesAlong(frameSize.width, tileSize.width, config_.overlap);
+    int rows = tilesAlong(frameSize.height, tileSize.height, config_.overlap);
+    while (static_cast<size_t>(cols * rows) > config_.maxTiles) {
+        // Give up native scale along the axis with the most tiles, or on a
+        // tie along the frame's shorter side
+        if (cols > rows || (cols == rows && frameSize.width < frameSize.height)) {
+            --cols;
+        } else {
+            --rows;
+        }
+    }
+
+    const int width = tileExtent(frameSize.width, tileSize.width, config_.overlap, cols);
+    const int height = tileExtent(frameSize.height, tileSize.height, config_.overlap, rows);
+    tiles.clear();
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            tiles.emplace_back(tileOffset(frameSize.width, width, cols, col),
+                               tileOffset(frameSize.height, height, rows, row), width, height);
+        }
+    }
+}
+
+RegionMerger::RegionMerger(size_t maxDetections) {
+    candidates_.reserve(maxDetections);
+    nms_.reserve(maxDetections);
+    keep_.reserve(maxDetections);
+    boxes_.reserve(maxDetections);
+    sources_.reserve(maxDetections);
+}
+
+void RegionMerger::merge(const std::vector<YOLODetector::DetectionResult>* perImage,
+                         const RegionInput* regions, int count, float iouThreshold,
+                         std::vector<YOLODetector::DetectionResult>& results) {
+    results.clear();
+    if (count == 1) {
+        // A single crop cannot overlap itself
+        for (const auto& det : perImage[regions[0].image]) {
+            if (inCell(regions[0], det.box)) {
+                results.push_back(det);
+                results.back().box = mapToFrame(regions[0], det.box);
+            }
+        }
+        return;
+    }
+
+    candidates_.clear();
+    boxes_.clear();
+    sources_.clear();
+    for (int index = 0; index < count; ++index) {
+        const RegionInput& region = regions[index];
+        for (const auto& det : perImage[region.image]) {
+            if (!inCell(region, det.box)) {
+                continue;
+            }
+            const cv::Rect box = mapToFrame(region, det.box);
+            if (!candidates_.push(static_cast<float>(box.x), static_cast<float>(box.y),
+                                  static_cast<float>(box.x + box.width),
+                                  static_cast<float>(box.y + box.height),
+                                  det.confidence, det.classId)) {
+                continue;  // Over capacity
+            }
+            boxes_.push_back(box);
+            sources_.push_back(&det);
+        }
+    }
+
+    dropped_ += candidates_.overflows;
+    
+    nms_.run(candidates_, iouThreshold, 0, keep_);
+    for (int index : keep_) {
+        results.push_back(*sources_[index]);
+        results.back().box = boxes_[index];
+    }
+}
+
+} // namespace rt
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "nms.hpp"
+#include "yolo_decoder.hpp"
+#include "yolo_detector.hpp"
+#include "../processing/letterbox.hpp"
+
+namespace rt {
+
+// One crop cut from a camera frame: the crop in frame pixels, the network
+// image it was letterboxed into, and where. Several crops can share one
+// image as cells of a mosaic; an empty cell means the whole image. A
+// full-frame pass is the region covering the whole frame.
+struct RegionInput {
+    cv::Rect roi;
+    LetterboxTransform transform;
+    int image{0};
+    cv::Rect cell;
+};
+
+// Splits the network input into count cells in a near-square grid, so
+// that count crops run as one image. The last row's cells share its full
+// width, so the cells always cover the whole input.
+void planMosaic(const cv::Size& inputSize, int count, std::vector<cv::Rect>& cells);
+
+// Chooses the crops to run the network on, given the objects known from
+// tracking. Each known box is padded (and grown to minSize), overlapping
+// crops are merged, and everything is clamped to the frame. plan() asks
+// for a full-frame pass instead when one is due (every fullFrameInterval
+// frames, to discover new objects), when nothing is known, or when the
+// crops would not pay off: more than maxRegions, or covering more than
+// maxCoverage of the frame.
+class RoiPlanner {
+public:
+    struct Config {
+        float padding{0.25f};       // of the box's longer side, on every edge
+        int minSize{96};            // crops narrower than this are grown
+        size_t maxRegions{3};
+        float maxCoverage{0.5f};
+        int fullFrameInterval{10};
+        size_t maxKnown{128};       // capacity reserved for the merge
+    };
+
+    explicit RoiPlanner(const Config& config);
+
+    // Returns true with the crops in regions, or false for a full frame
+    bool plan(const std::vector<cv::Rect>& known, const cv::Size& frameSize,
+              std::vector<cv::Rect>& regions);
+
+private:
+    Config config_;
+    int sinceFullFrame_;
+    std::vector<cv::Rect> work_;
+};
+
+// Splits a frame into a grid of overlapping tiles the size of the network
+// input, so each tile runs at native scale and small objects keep their
+// pixels. Neighbouring tiles overlap by at least overlap pixels, enough
+// for an object cut by one tile edge to be whole in the next tile. When
+// the grid would need more than maxTiles tiles, fewer and larger tiles are
+// used instead and letterboxed down.
+class TilePlanner {
+public:
+    struct Config {
+        int overlap{64};
+        size_t maxTiles{4};
+    };
+
+    explicit TilePlanner(const Config& config);
+
+    // Tiles in row-major order, clamped to the frame
+    void plan(const cv::Size& frameSize, const cv::Size& tileSize,
+              std::vector<cv::Rect>& tiles) const;
+
+private:
+    Config config_;
+};
+
+// Brings per-crop detections back into frame pixels and removes the
+// duplicates of objects seen by more than one crop with class-aware NMS.
+// A detection belongs to the crop whose cell holds its centre. Scratch is
+// reserved for maxDetections boxes over all crops; boxes beyond that are
+// dropped and counted.
+class RegionMerger {
+public:
+    explicit RegionMerger(size_t maxDetections);
+
+    // perImage[regions[i].image] holds the detections of regions[i] in
+    // network pixels
+    void merge(const std::vector<YOLODetector::DetectionResult>* perImage,
+               const RegionInput* regions, int count, float iouThreshold,
+               std::vector<YOLODetector::DetectionResult>& results);
+
+    // Boxes dropped for capacity over all merges
+    uint64_t droppedCandidates() const { return dropped_; }
+
+private:
+    CandidateBuffer candidates_;
+    NmsEngine nms_;
+    std::vector<int> keep_;
+    std::vector<cv::Rect> boxes_;
+    std::vector<const YOLODetector::DetectionResult*> sources_;
+    uint64_t dropped_{0};
+};
+
+} // namespace rt
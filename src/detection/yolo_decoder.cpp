@@ -0,0 +1,172 @@
+#include "yolo_decoder.hpp"
+#include <algorithm>
+
+#if RT_HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace rt {
+
+namespace {
+
+constexpr int kObjectness = 4;
+constexpr int kFirstClass = 5;
+
+int argmaxScalar(const float* scores, int count) {
+    int best = 0;
+    for (int c = 1; c < count; ++c) {
+        if (scores[c] > scores[best]) {
+            best = c;
+        }
+    }
+    return best;
+}
+
+void emit(const float* row, int classId, float confidence, const cv::Size& inputSize,
+          CandidateBuffer& candidates) {
+    const float cx = row[0] * inputSize.width;
+    const float cy = row[1] * inputSize.height;
+    const float halfWidth = row[2] * inputSize.width * 0.5f;
+    const float halfHeight = row[3] * inputSize.height * 0.5f;
+    candidates.push(cx - halfWidth, cy - halfHeight, cx + halfWidth, cy + halfHeight,
+                    confidence, classId);
+}
+
+void decodeRow(const float* row, int numClasses, float confThreshold,
+               const cv::Size& inputSize, CandidateBuffer& candidates) {
+    const float* scores = row + kFirstClass;
+    const int classId = argmaxScalar(scores, numClasses);
+    if (scores[classId] > confThreshold) {
+        emit(row, classId, scores[classId], inputSize, candidates);
+    }
+}
+
+void decodeScalar(const YoloOutputView& view, float confThreshold,
+                  const cv::Size& inputSize, CandidateBuffer& candidates) {
+    const int numClasses = view.cols - kFirstClass;
+    for (int i = 0; i < view.rows; ++i) {
+        const float* row = view.data + static_cast<size_t>(i) * view.cols;
+        if (row[kObjectness] > confThreshold) {
+            decodeRow(row, numClasses, confThreshold, inputSize, candidates);
+        }
+    }
+}
+
+#if RT_HAVE_X86_SIMD
+
+// First index of the maximum, same tie-breaking as the scalar loop
+RT_TARGET_AVX2
+int argmaxAVX2(const float* scores, int count) {
+    if (count < 8) {
+        return argmaxScalar(scores, count);
+    }
+
+    __m256 best = _mm256_loadu_ps(scores);
+    int c = 8;
+    for (; c + 8 <= count; c += 8) {
+        best = _mm256_max_ps(best, _mm256_loadu_ps(scores + c));
+    }
+    __m128 lanes = _mm_max_ps(_mm256_castps256_ps128(best), _mm256_extractf128_ps(best, 1));
+    lanes = _mm_max_ps(lanes, _mm_movehl_ps(lanes, lanes));
+    lanes = _mm_max_ss(lanes, _mm_shuffle_ps(lanes, lanes, 1));
+    float maximum = _mm_cvtss_f32(lanes);
+    for (int t = c; t < count; ++t) {
+        maximum = scores[t] > maximum ? scores[t] : maximum;
+    }
+
+    const __m256 target = _mm256_set1_ps(maximum);
+    for (int i = 0; i + 8 <= count; i += 8) {
+        const int mask = _mm256_movemask_ps(
+            _mm256_cmp_ps(_mm256_loadu_ps(scores + i), target, _CMP_EQ_OQ));
+        if (mask) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    for (int t = count & ~7; t < count; ++t) {
+        if (scores[t] == maximum) {
+            return t;
+        }
+    }
+    return 0;
+}
+
+RT_TARGET_AVX2
+void decodeRowAVX2(const float* row, int numClasses, float confThreshold,
+                   const cv::Size& inputSize, CandidateBuffer& candidates) {
+    const float* scores = row + kFirstClass;
+    const int classId = argmaxAVX2(scores, numClasses);
+    if (scores[classId] > confThreshold) {
+        emit(row, classId, scores[classId], inputSize, candidates);
+    }
+}
+
+RT_TARGET_AVX2
+void decodeAVX2(const YoloOutputView& view, float confThreshold,
+                const cv::Size& inputSize, CandidateBuffer& candidates) {
+    const int numClasses = view.cols - kFirstClass;
+    const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                               _mm256_set1_epi32(view.cols));
+    const __m256 threshold = _mm256_set1_ps(confThreshold);
+
+    // Objectness of eight rows per gather; most rows fail here
+    int i = 0;
+    for (; i + 8 <= view.rows; i += 8) {
+        const float* block = view.data + static_cast<size_t>(i) * view.cols;
+        const __m256 objectness = _mm256_i32gather_ps(block + kObjectness, offsets, 4);
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(objectness, threshold, _CMP_GT_OQ));
+        while (mask) {
+            const int lane = __builtin_ctz(mask);
+            mask &= mask - 1;
+            decodeRowAVX2(block + static_cast<size_t>(lane) * view.cols, numClasses,
+                          confThreshold, inputSize, candidates);
+        }
+    }
+    for (; i < view.rows; ++i) {
+        const float* row = view.data + static_cast<size_t>(i) * view.cols;
+        if (row[kObjectness] > confThreshold) {
+            decodeRowAVX2(row, numClasses, confThreshold, inputSize, candidates);
+        }
+    }
+}
+
+#endif
+
+} // namespace
+
+void CandidateBuffer::reserve(size_t capacity) {
+    x0.reserve(capacity);
+    y0.reserve(capacity);
+    x1.reserve(capacity);
+    y1.reserve(capacity);
+    score.reserve(capacity);
+    classId.reserve(capacity);
+    capacity_ = std::max(capacity_, capacity);
+}
+
+void CandidateBuffer::clear() {
+    x0.clear();
+    y0.clear();
+    x1.clear();
+    y1.clear();
+    score.clear();
+    classId.clear();
+    overflows = 0;
+}
+
+void decodeYoloOutput(const YoloOutputView& view, float confThreshold,
+                      const cv::Size& inputSize, CandidateBuffer& candidates,
+                      SimdLevel level) {
+    if (view.cols <= kFirstClass || view.rows <= 0) {
+        return;
+    }
+
+#if RT_HAVE_X86_SIMD
+    if (std::min(level, detectSimdLevel()) == SimdLevel::AVX2) {
+        decodeAVX2(view, confThreshold, inputSize, candidates);
+        return;
+    }
+#endif
+    decodeScalar(view, confThreshold, inputSize, candidates);
+}
+
+} // namespace rt
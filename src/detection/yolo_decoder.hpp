@@ -0,0 +1,67 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <vector>
+#include "../utils/cpu_features.hpp"
+
+namespace rt {
+
+// Detection candidates in structure-of-arrays form, so later stages (NMS)
+// can run SIMD over one coordinate at a time. Capacity is fixed by
+// reserve(); pushes beyond it are counted instead of reallocating.
+struct CandidateBuffer {
+    std::vector<float> x0;  // corners in network input pixels
+    std::vector<float> y0;
+    std::vector<float> x1;
+    std::vector<float> y1;
+    std::vector<float> score;
+    std::vector<int> classId;
+    size_t overflows{0};
+
+    // Only allocates when capacity grows, i.e. during warmup
+    void reserve(size_t capacity);
+    void clear();
+    size_t size() const { return score.size(); }
+    size_t capacity() const { return capacity_; }
+
+    bool push(float left, float top, float right, float bottom, float confidence, int cls) {
+        if (score.size() == capacity_) {
+            ++overflows;
+            return false;
+        }
+        x0.push_back(left);
+        y0.push_back(top);
+        x1.push_back(right);
+        y1.push_back(bottom);
+        score.push_back(confidence);
+        classId.push_back(cls);
+        return true;
+    }
+
+    cv::Rect rect(size_t i) const {
+        return cv::Rect(static_cast<int>(x0[i]), static_cast<int>(y0[i]),
+                        static_cast<int>(x1[i] - x0[i]), static_cast<int>(y1[i] - y0[i]));
+    }
+
+private:
+    size_t capacity_{0};
+};
+
+// Rows of one image in a Darknet YOLO output: centre x, centre y, width,
+// height (all relative), objectness, then per-class scores
+struct YoloOutputView {
+    const float* data;
+    int rows;
+    int cols;
+};
+
+// Appends every row whose best class score beats confThreshold. Class
+// scores never exceed objectness, so rows are first rejected on objectness
+// alone (eight at a time with AVX2) and the class argmax only runs for the
+// few survivors.
+void decodeYoloOutput(const YoloOutputView& view, float confThreshold,
+                      const cv::Size& inputSize, CandidateBuffer& candidates,
+                      SimdLevel level = detectSimdLevel());
+
+} // namespace rt
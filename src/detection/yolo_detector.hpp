@@ -1,10 +1,15 @@
 #pragma once
 
 #include <opencv2/dnn.hpp>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <memory>
+#include "yolo_decoder.hpp"
+#include "nms.hpp"
+#include "yolo_model.hpp"
 #include "../utils/performance_monitor.hpp"
+#include "../utils/inference_threads.hpp"
 
 namespace rt {
 
@@ -15,6 +20,9 @@ public:
         float confidence;
         cv::Rect box;
         std::string className;
+        // Along the optical axis in calibration units, when a depth stage
+        // ran; 0 if unknown
+        float distance{0.0f};
     };
 
     struct Config {
@@ -26,17 +34,76 @@ public:
         int inputWidth;
         int inputHeight;
         bool useGPU;
+        // Per-frame cap on detections; bounds NMS in crowded scenes.
+        // 0 keeps every box that survives suppression.
+        size_t maxDetections{0};
+        // OpenCV worker threads for inference (0 = OpenCV default) and the
+        // cores they may use (0 = any); see configureInferenceThreads()
+        int inferenceThreads{0};
+        CpuMask inferenceCpuMask{0};
     };
 
+    // Loads the model from the paths in config, then builds as below
     explicit YOLODetector(const Config& config);
 
+    // Builds this detector's own net from an already loaded model, so
+    // detectors for several threads read the model files only once. The
+    // model paths in config are ignored.
+    YOLODetector(const Config& config, std::shared_ptr<const YoloModel> model);
+    ~YOLODetector();
+
     std::vector<DetectionResult> detect(const cv::Mat& frame);
+
+    // Runs the network on an input that is already letterboxed, RGB and
+    // scaled to [0, 1] in NCHW layout (see BlobKernel), skipping
+    // preprocess(); boxes come back in network input pixels
+    std::vector<DetectionResult> detectBlob(const cv::Mat& blob);
+
+    // Input tensors owned by the detector, each {batchSize, 3, H, W} float.
+    // Reserve them during setup; a producer then fills the images of a slot
+    // in place (e.g. with BlobKernel) and the consumer runs detectPrepared()
+    // or detectBatch() on it, so nothing is copied or allocated between the
+    // two stages.
+    void reserveInputs(size_t count, int batchSize = 1);
+    size_t inputCount() const { return inputTensors_.size(); }
+    int inputBatchSize() const { return inputBatchSize_; }
+    cv::Mat& inputTensor(size_t slot);
+    float* inputImage(size_t slot, int image);
+
+    // Adaptive resolution. Builds one net per input size (ascending), apart
+    // from the detector's own, and runs each once, so switching sizes later
+    // costs nothing; call after reserveInputs(). batches[level] is the image
+    // count detectBatch() will run at that level (default the reserved batch
+    // size) and the warm-up runs at it; other counts still work but reshape
+    // the net, allocating on the first pass. Without this there is a single
+    // level, the Config input size.
+    void reserveResolutions(const std::vector<cv::Size>& sizes,
+                            const std::vector<int>& batches = {});
+    size_t resolutionCount() const { return std::max<size_t>(resolutions_.size(), 1); }
+    cv::Size resolution(size_t level) const;
+    // Images the level's net was warmed at
+    int resolutionBatch(size_t level) const;
+
+    // Each input slot carries its own level, chosen by the producer before
+    // it fills the slot; inputTensor(), inputImage() and detectBatch() on
+    // that slot then use that size. Boxes come back in its pixels.
+    void setInputResolution(size_t slot, size_t level);
+    size_t inputResolution(size_t slot) const;
+
+    // Results are written into the caller's vector to reuse its capacity
+    void detectPrepared(size_t slot, std::vector<DetectionResult>& results);
+
+    // Runs the first count images of a slot as one batched forward pass,
+    // which amortizes per-layer overhead and weight loads across images;
+    // results[i] receives the detections of image i
+    void detectBatch(size_t slot, int count, std::vector<DetectionResult>* results);
     void warmup();  // Run inference on dummy data to initialize
     
     // Performance metrics
     double getInferenceTime() const;
     double getPreprocessTime() const;
     double getPostprocessTime() const;
+    int getInferenceThreadCount() const { return inferenceThreadCount_; }
 
 private:
     cv::Mat preprocess(const cv::Mat& frame);
@@ -48,7 +115,13 @@ private:
     cv::dnn::Net net_;
     std::vector<std::string> classes_;
     Config config_;
+    std::shared_ptr<const YoloModel> model_;
     
+    void infer(cv::dnn::Net& net, const cv::Size& inputSize, const cv::Mat& blob, int count,
+               std::vector<DetectionResult>* results);
+    void decode(int image, int count, const cv::Size& inputSize,
+                std::vector<DetectionResult>& results);
+
     std::vector<std::string> getOutputsNames();
     void drawPredictions(cv::Mat& frame, 
                         const std::vector<DetectionResult>& results);
@@ -58,4 +131,24 @@ private:
     // Cache for performance
     std::vector<cv::Mat> outs_;
     std::vector<std::string> outLayerNames_;
+    int inputBatchSize_{0};
+    int inferenceThreadCount_{0};
+
+    struct Resolution {
+        cv::Size size;
+        cv::dnn::Net net;
+        int batch;
+    };
+    std::vector<Resolution> resolutions_;
+
+    // One buffer per slot, big enough for the largest resolution, with a
+    // tensor header per level over it
+    std::vector<cv::Mat> inputStorage_;
+    std::vector<std::vector<cv::Mat>> inputTensors_;
+    std::vector<size_t> inputLevels_;
+
+    // Decode scratch, reused across frames
+    CandidateBuffer candidates_;
+    NmsEngine nms_;
+    std::vector<int> keep_;
 }; 
\ No newline at end of file
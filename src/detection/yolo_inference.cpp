@@ -0,0 +1,240 @@
+#include "yolo_detector.hpp"
+#include <stdexcept>
+#include <utility>
+
+namespace rt {
+
+namespace {
+
+// Rows of one image within a YOLO output blob. Batched Darknet outputs are
+// either {batch, rows, cols} or, on older OpenCV, {batch * rows, cols}.
+YoloOutputView imageRows(const cv::Mat& out, int image, int count) {
+    if (out.dims == 3) {
+        return {out.ptr<float>(image), out.size[1], out.size[2]};
+    }
+    const int rows = out.rows / count;
+    return {out.ptr<float>(image * rows), rows, out.cols};
+}
+
+} // namespace
+
+YOLODetector::YOLODetector(const Config& config)
+    : YOLODetector(config, YoloModel::load(config.modelPath, config.configPath,
+                                           config.classesPath)) {
+}
+
+YOLODetector::YOLODetector(const Config& config, std::shared_ptr<const YoloModel> model)
+    : classes_(model->classes())
+    , config_(config)
+    , model_(std::move(model)) {
+    if (config.confThreshold < 0.0f || config.confThreshold > 1.0f) {
+        throw std::invalid_argument("Confidence threshold must be between 0 and 1");
+    }
+    if (config.nmsThreshold < 0.0f || config.nmsThreshold > 1.0f) {
+        throw std::invalid_argument("NMS threshold must be between 0 and 1");
+    }
+
+    inferenceThreadCount_ = configureInferenceThreads(config.inferenceThreads,
+                                                      config.inferenceCpuMask);
+    net_ = model_->createNet(config.useGPU);
+    outLayerNames_ = net_.getUnconnectedOutLayersNames();
+}
+
+YOLODetector::~YOLODetector() = default;
+
+std::vector<YOLODetector::DetectionResult> YOLODetector::detectBlob(const cv::Mat& blob) {
+    if (blob.dims != 4 || blob.size[0] != 1 || blob.size[1] != 3 ||
+        blob.size[2] != config_.inputHeight || blob.size[3] != config_.inputWidth) {
+        throw std::invalid_argument("Detector blob must be 1x3xHxW at the network input size");
+    }
+
+    std::vector<DetectionResult> results;
+    infer(net_, cv::Size(config_.inputWidth, config_.inputHeight), blob, 1, &results);
+    return results;
+}
+
+void YOLODetector::reserveInputs(size_t count, int batchSize) {
+    if (batchSize <= 0) {
+        throw std::invalid_argument("Detector input batch size must be positive");
+    }
+
+    size_t maxArea = 0;
+    for (size_t level = 0; level < resolutionCount(); ++level) {
+        maxArea = std::max(maxArea, static_cast<size_t>(resolution(level).area()));
+    }
+
+    inputStorage_.resize(count);
+    inputTensors_.resize(count);
+    inputLevels_.assign(count, 0);
+    for (size_t slot = 0; slot < count; ++slot) {
+        inputStorage_[slot].create(1, static_cast<int>(batchSize * 3 * maxArea), CV_32F);
+        inputTensors_[slot].clear();
+        for (size_t level = 0; level < resolutionCount(); ++level) {
+            const cv::Size size = resolution(level);
+            const int shape[] = {batchSize, 3, size.height, size.width};
+            inputTensors_[slot].emplace_back(4, shape, CV_32F, inputStorage_[slot].data);
+        }
+    }
+    inputBatchSize_ = batchSize;
+}
+
+void YOLODetector::reserveResolutions(const std::vector<cv::Size>& sizes,
+                                      const std::vector<int>& batches) {
+    if (sizes.empty()) {
+        throw std::invalid_argument("Detector needs at least one input resolution");
+    }
+    if (!batches.empty() && batches.size() != sizes.size()) {
+        throw std::invalid_argument("Detector needs one batch size per input resolution");
+    }
+    const int reserved = std::max(inputBatchSize_, 1);
+    for (int batch : batches) {
+        if (batch <= 0 || batch > reserved) {
+            throw std::invalid_argument("Detector batch of " + std::to_string(batch) +
+                                        " does not fit the reserved inputs");
+        }
+    }
+    for (size_t level = 0; level < sizes.size(); ++level) {
+        if (sizes[level].width <= 0 || sizes[level].height <= 0 ||
+            (level > 0 && sizes[level].area() <= sizes[level - 1].area())) {
+            throw std::invalid_argument("Detector resolutions must be positive and ascending");
+        }
+    }
+
+    // Built from the model already in memory. net_ stays with detect(),
+    // detectBlob() and warmup() at the Config size, so those never reshape
+    // a level under the resolution controller.
+    resolutions_.clear();
+    for (size_t level = 0; level < sizes.size(); ++level) {
+        resolutions_.push_back({sizes[level], model_->createNet(config_.useGPU),
+                                batches.empty() ? reserved : batches[level]});
+    }
+
+    // Re-lay the slots for the new sizes, then run every net once at the
+    // batch it will see: layer buffers and decode scratch are allocated
+    // here, not on a switch
+    if (!inputStorage_.empty()) {
+        reserveInputs(inputStorage_.size(), inputBatchSize_);
+    }
+    std::vector<std::vector<DetectionResult>> scratch(reserved);
+    for (Resolution& level : resolutions_) {
+        const int shape[] = {level.batch, 3, level.size.height, level.size.width};
+        const cv::Mat zeros(4, shape, CV_32F, cv::Scalar(0));
+        infer(level.net, level.size, zeros, level.batch, scratch.data());
+    }
+}
+
+cv::Size YOLODetector::resolution(size_t level) const {
+    if (level >= resolutionCount()) {
+        throw std::out_of_range("Detector resolution level " + std::to_string(level) +
+                                " not reserved");
+    }
+    return resolutions_.empty() ? cv::Size(config_.inputWidth, config_.inputHeight)
+                                : resolutions_[level].size;
+}
+
+int YOLODetector::resolutionBatch(size_t level) const {
+    if (level >= resolutionCount()) {
+        throw std::out_of_range("Detector resolution level " + std::to_string(level) +
+                                " not reserved");
+    }
+    return resolutions_.empty() ? inputBatchSize_ : resolutions_[level].batch;
+}
+
+void YOLODetector::setInputResolution(size_t slot, size_t level) {
+    inputTensor(slot);  // Validates the slot
+    if (level >= resolutionCount()) {
+        throw std::out_of_range("Detector resolution level " + std::to_string(level) +
+                                " not reserved");
+    }
+    inputLevels_[slot] = level;
+}
+
+size_t YOLODetector::inputResolution(size_t slot) const {
+    if (slot >= inputLevels_.size()) {
+        throw std::out_of_range("Detector input slot " + std::to_string(slot) +
+                                " not reserved");
+    }
+    return inputLevels_[slot];
+}
+
+cv::Mat& YOLODetector::inputTensor(size_t slot) {
+    if (slot >= inputTensors_.size()) {
+        throw std::out_of_range("Detector input slot " + std::to_string(slot) +
+                                " not reserved");
+    }
+    return inputTensors_[slot][inputLevels_[slot]];
+}
+
+float* YOLODetector::inputImage(size_t slot, int image) {
+    if (image < 0 || image >= inputBatchSize_) {
+        throw std::out_of_range("Detector input image " + std::to_string(image) +
+                                " outside the batch");
+    }
+    return inputTensor(slot).ptr<float>(image);
+}
+
+void YOLODetector::detectPrepared(size_t slot, std::vector<DetectionResult>& results) {
+    detectBatch(slot, 1, &results);
+}
+
+void YOLODetector::detectBatch(size_t slot, int count, std::vector<DetectionResult>* results) {
+    cv::Mat& tensor = inputTensor(slot);
+    if (count <= 0 || count > inputBatchSize_) {
+        throw std::out_of_range("Detector batch of " + std::to_string(count) +
+                                " does not fit the reserved inputs");
+    }
+
+    const size_t level = inputLevels_[slot];
+    cv::dnn::Net& net = resolutions_.empty() ? net_ : resolutions_[level].net;
+    const cv::Size size = resolution(level);
+    if (count == inputBatchSize_) {
+        infer(net, size, tensor, count, results);
+        return;
+    }
+
+    // Partial batch: a header over the leading images, the data is shared
+    const int shape[] = {count, 3, size.height, size.width};
+    infer(net, size, cv::Mat(4, shape, CV_32F, tensor.data), count, results);
+}
+
+void YOLODetector::infer(cv::dnn::Net& net, const cv::Size& inputSize, const cv::Mat& blob,
+                         int count, std::vector<DetectionResult>* results) {
+    net.setInput(blob);
+    net.forward(outs_, outLayerNames_);
+    for (int image = 0; image < count; ++image) {
+        decode(image, count, inputSize, results[image]);
+    }
+}
+
+void YOLODetector::decode(int image, int count, const cv::Size& inputSize,
+                          std::vector<DetectionResult>& results) {
+    size_t totalRows = 0;
+    for (const cv::Mat& out : outs_) {
+        totalRows += imageRows(out, image, count).rows;
+    }
+    candidates_.clear();
+    if (candidates_.capacity() < totalRows) {
+        // First frame only: size all decode and NMS scratch to the outputs
+        candidates_.reserve(totalRows);
+        nms_.reserve(totalRows);
+        keep_.reserve(totalRows);
+    }
+
+    for (const cv::Mat& out : outs_) {
+        decodeYoloOutput(imageRows(out, image, count), config_.confThreshold, inputSize,
+                         candidates_);
+    }
+
+    nms_.run(candidates_, config_.nmsThreshold, config_.maxDetections, keep_);
+
+    results.clear();
+    results.reserve(keep_.size());  // No-op for callers reusing a vector
+    for (int index : keep_) {
+        const int classId = candidates_.classId[index];
+        results.push_back({classId, candidates_.score[index], candidates_.rect(index),
+                           classId < static_cast<int>(classes_.size()) ? classes_[classId]
+                                                                        : std::string()});
+    }
+}
+
+} // namespace rt
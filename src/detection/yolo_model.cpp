@@ -0,0 +1,54 @@
+#include "yolo_model.hpp"
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace rt {
+
+namespace {
+
+std::vector<uchar> readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot open model file " + path);
+    }
+    return std::vector<uchar>(std::istreambuf_iterator<char>(file),
+                              std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+std::shared_ptr<const YoloModel> YoloModel::load(const std::string& modelPath,
+                                                 const std::string& configPath,
+                                                 const std::string& classesPath) {
+    std::shared_ptr<YoloModel> model(new YoloModel());
+    model->config_ = readFile(configPath);
+    model->weights_ = readFile(modelPath);
+
+    std::ifstream classes(classesPath);
+    if (!classes) {
+        throw std::runtime_error("Cannot open class names " + classesPath);
+    }
+    for (std::string name; std::getline(classes, name);) {
+        model->classes_.push_back(name);
+    }
+    return model;
+}
+
+cv::dnn::Net YoloModel::createNet(bool useGPU) const {
+    cv::dnn::Net net = cv::dnn::readNetFromDarknet(config_, weights_);
+    if (net.empty()) {
+        throw std::runtime_error("Failed to build the network from the model buffers");
+    }
+
+    if (useGPU) {
+        net.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
+        net.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
+    } else {
+        net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    }
+    return net;
+}
+
+} // namespace rt
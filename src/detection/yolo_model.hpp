@@ -0,0 +1,40 @@
+#pragma once
+
+#include <opencv2/dnn.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rt {
+
+// Darknet model files read into memory once and never modified afterwards,
+// so any number of detectors on any threads can build their nets from it.
+// Each cv::dnn::Net still keeps its own layer blobs and workspace; what is
+// shared is the file I/O, the raw weights and the class names.
+//
+// The raw buffers stay resident for the model's lifetime: nets are still
+// built after construction, one per resolution level in
+// YOLODetector::reserveResolutions() and one per detector a pool adds, and
+// each needs them. So N detectors hold their N parsed nets plus this one
+// copy of the files; drop the last shared_ptr once every net is built to
+// free it.
+class YoloModel {
+public:
+    static std::shared_ptr<const YoloModel> load(const std::string& modelPath,
+                                                 const std::string& configPath,
+                                                 const std::string& classesPath);
+
+    // A fresh, independent net on the requested backend
+    cv::dnn::Net createNet(bool useGPU) const;
+
+    const std::vector<std::string>& classes() const { return classes_; }
+
+private:
+    YoloModel() = default;
+
+    std::vector<uchar> config_;
+    std::vector<uchar> weights_;
+    std::vector<std::string> classes_;
+};
+
+} // namespace rt
@@ -1,27 +1,203 @@
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <atomic>
 #include <signal.h>
 #include <spdlog/spdlog.h>
 #include <fmt/format.h>
 #include <alchemy/task.h>
 #include <alchemy/timer.h>
-#include <alchemy/mutex.h>
 #include <alchemy/sem.h>
 #include "camera/stereo_capture.hpp"
+#include "camera/stereo_synchronizer.hpp"
+#include "camera/replay_frame_source.hpp"
+#include "camera/stereo_calibration.hpp"
+#include "camera/stereo_rectifier.hpp"
+#include "camera/stereo_overlay.hpp"
 #include "detection/yolo_detector.hpp"
+#include "detection/async_detector.hpp"
+#include "detection/resolution_controller.hpp"
+#include "detection/roi_inference.hpp"
+#include "processing/blob_kernel.hpp"
+#include "processing/letterbox.hpp"
+#include "processing/motion_gate.hpp"
+#include "processing/depth_estimator.hpp"
 #include "scheduler/rt_scheduler.hpp"
+#include "tracking/object_tracker.hpp"
 #include "utils/performance_monitor.hpp"
+#include "utils/spsc_queue.hpp"
+#include "utils/triple_buffer.hpp"
+#include "utils/inference_threads.hpp"
 
 namespace {
     volatile std::sig_atomic_t gSignalStatus;
-    RT_MUTEX frameMutex;
     RT_SEM frameSync;
     RT_SEM preprocessSync;
     RT_SEM detectionSync;
+    RT_SEM rightEyeStart;
+    RT_SEM rightEyeDone;
+    RT_SEM inferenceStart;
+    RT_SEM rightRetrieve;
     
-    // Shared buffers
-    cv::Mat mergedFrame;
-    cv::Mat preprocessedFrame;
-    std::vector<rt::YOLODetector::DetectionResult> detectionResults;
+    // Camera setup: device, width, height, fps, core, format. YUYV frames
+    // leave the camera cores packed; the preprocess kernels convert only
+    // the pixels they sample. With rectification the cameras deliver BGR
+    // instead, see createCaptureSystem().
+    const rt::StereoCaptureSystem::CameraConfig LEFT_CAMERA{0, 640, 480, 30, 2,
+                                                            rt::PixelFormat::YUYV};
+    const rt::StereoCaptureSystem::CameraConfig RIGHT_CAMERA{2, 640, 480, 30, 3,
+                                                             rt::PixelFormat::YUYV};
+    
+    // Frame geometry
+    // Detector input sizes, ascending; the detection task steps between
+    // them by deadline slack. A single entry fixes the resolution.
+    const std::vector<cv::Size> DETECTOR_INPUTS{{320, 320}, {416, 416}, {512, 512}};
+    // Crop passes run below those, each crop letterboxed into a CROP_INPUT
+    // image of its own, so a tracked pair infers a fraction of the pixels
+    // of a full-frame pass. It is detector level 0; DETECTOR_INPUTS[i] is
+    // level i + 1.
+    const cv::Size CROP_INPUT{160, 160};
+    const std::size_t CROP_LEVEL = 0;
+    const std::size_t STAGE_QUEUE_DEPTH = 4;
+    const std::size_t MAX_DETECTIONS = 128;
+    
+    // Rig calibration (OpenCV stereo_calib format); without it frames stay
+    // raw and detections carry no distance. The remap tables built from it
+    // are cached next to it; a RECTIFIED_SIZE below the camera size fuses
+    // a downscale into rectification.
+    const char* STEREO_CALIBRATION = "config/stereo_calibration.yml";
+    const char* RECTIFICATION_CACHE = "config/stereo_rectification.bin";
+    const cv::Size RECTIFIED_SIZE{640, 480};
+    
+    // The tracker carries objects between detections, so only every
+    // DETECTION_INTERVAL-th matched pair goes to the network; tracks
+    // survive TRACK_MAX_MISSES frames without a detection
+    const int DETECTION_INTERVAL = 3;
+    const int TRACK_MAX_MISSES = 2 * DETECTION_INTERVAL;
+    
+    // Inference stays off the camera cores 2 and 3: forward() runs on the
+    // calling task (Inference, or Detection when blocking), which is pinned
+    // to core 0 or 1, and OpenCV's workers are confined to both. The mask
+    // only reaches the workers with OpenCV's pthreads backend.
+    const int INFERENCE_THREADS = 2;
+    const rt::CpuMask INFERENCE_CPU_MASK = (1u << 0) | (1u << 1);
+    
+    enum class PreprocessMode {
+        Merged,  // squash the side-by-side view into one input (legacy)
+        PerEye   // one letterboxed input per eye, boxes in camera pixels
+    };
+    const PreprocessMode PREPROCESS_MODE = PreprocessMode::PerEye;
+    
+    enum class DetectionMode {
+        Blocking,   // the detection task runs each forward pass itself
+        Pipelined   // a worker task infers pair N while pair N+1 is preprocessed
+    };
+    const DetectionMode DETECTION_MODE = DetectionMode::Pipelined;
+    
+    enum class EyeMode {
+        Both,        // the network runs on both eyes
+        ProjectLeft  // runs on the left eye only; the depth stage finds each
+                     // box in the right eye (needs a calibrated rig)
+    };
+    const EyeMode EYE_MODE = EyeMode::ProjectLeft;
+    
+    enum class CaptureMode {
+        Independent,  // each camera task reads on its own period
+        Triggered     // the left task grabs both cameras back to back, then
+                      // each task decodes its own frame
+    };
+    const CaptureMode CAPTURE_MODE = CaptureMode::Triggered;
+    
+    enum Eye { LEFT_EYE = 0, RIGHT_EYE = 1, NUM_EYES = 2 };
+    
+    // How each eye is split into network images; picked per run with
+    // --tiled, see parseCommandLine()
+    enum class RegionLayout {
+        Tracked,  // full frame, and in between crop passes around tracked
+                  // objects
+        Tiled     // overlapping native-scale tiles: slower, keeps small objects
+    };
+    
+    // Images per eye: the full frame, up to MAX_REGIONS crops at
+    // CROP_INPUT, or MAX_TILES tiles that overlap by TILE_OVERLAP pixels.
+    // When only one eye has crops, they share a full-size mosaic image so
+    // the other eye's full frame can run in the same batch.
+    const int MAX_REGIONS = 3;
+    const int MAX_TILES = 4;
+    const int TILE_OVERLAP = 64;
+    const int MAX_IMAGES_PER_EYE = std::max(MAX_REGIONS, MAX_TILES);
+    const int MAX_IMAGES = NUM_EYES * MAX_IMAGES_PER_EYE;
+    const float REGION_MERGE_IOU = 0.45f;  // duplicates across crops and tiles
+    
+    // Network inputs for one matched stereo pair. The tensor itself lives
+    // in the detector; each ring slot owns one, and the images of both eyes
+    // run through the network as a single batch. An eye's regions are
+    // contiguous, starting at first[eye], and each names its image.
+    struct DetectionInput {
+        std::size_t tensor = 0;  // detector input slot
+        rt::FramePool::Handle left;   // held for the depth stage
+        rt::FramePool::Handle right;
+        std::array<rt::RegionInput, MAX_IMAGES> regions;
+        std::array<int, NUM_EYES> first{};
+        std::array<int, NUM_EYES> count{};
+        int numRegions = 0;
+        int numInputs = 0;  // images in the batch
+        // When preprocess took the pair, within a preprocess period of its
+        // capture; live and replayed frames share this clock
+        RTIME taken = 0;
+    };
+    
+    // Detections per eye; in merged mode everything lands in the left slot
+    struct StereoDetections {
+        std::array<std::vector<rt::YOLODetector::DetectionResult>, NUM_EYES> eyes;
+        RTIME taken = 0;  // of the pair they were found in
+    };
+    
+    using CaptureQueue = rt::SpscQueue<rt::FramePool::Handle, STAGE_QUEUE_DEPTH>;
+    using InputQueue = rt::SpscQueue<DetectionInput, STAGE_QUEUE_DEPTH>;
+    using ResultQueue = rt::SpscQueue<StereoDetections, STAGE_QUEUE_DEPTH>;
+    
+    // Stage edges: every ring has exactly one producer and one consumer task,
+    // and all slots are allocated here, before any RT task starts. Camera
+    // edges carry handles into the capture system's frame pools.
+    CaptureQueue leftFrames;
+    CaptureQueue rightFrames;
+    InputQueue detectionInputs([next = std::size_t{0}](DetectionInput& slot) mutable {
+        slot.tensor = next++;
+    });
+    ResultQueue detectionResults([](StereoDetections& slot) {
+        for (auto& eye : slot.eyes) {
+            eye.reserve(MAX_DETECTIONS);
+        }
+    });
+    
+    // Handoff from the preprocess task to the right-eye helper task;
+    // rightEyeStart/rightEyeDone order every access
+    struct EyeJob {
+        const cv::Mat* frame = nullptr;
+        DetectionInput* input = nullptr;
+        std::size_t level = 0;
+    };
+    EyeJob rightEyeJob;
+    
+    // Boxes of the confirmed tracks, published by the display task for
+    // preprocess to plan crops around
+    struct KnownObjects {
+        std::array<std::vector<cv::Rect>, NUM_EYES> eyes;
+    };
+    rt::TripleBuffer<KnownObjects> knownObjects([](KnownObjects& known) {
+        for (auto& eye : known.eyes) {
+            eye.reserve(MAX_DETECTIONS);
+        }
+    });
+    
+    // Index into DETECTOR_INPUTS for the next full-frame input; written by
+    // the detection task, read by preprocess. Each slot records the
+    // detector level it was filled at.
+    std::atomic<std::size_t> inputLevel{DETECTOR_INPUTS.size() - 1};
     
     // Timing constants (in nanoseconds)
     const RTIME CYCLE_TIME_NS = 660000000;  // 0.66 seconds total cycle
@@ -30,6 +206,23 @@ namespace {
     const RTIME DETECTION_PERIOD_NS = 220000000;  // ~0.22s for detection
     const RTIME MONITOR_PERIOD_NS = 110000000;  // ~0.11s for monitoring
     const RTIME DISPLAY_PERIOD_NS = 110000000;  // ~0.11s for display
+    const RTIME STEREO_SKEW_WINDOW_NS = 16000000;  // half a 30 fps camera frame
+    
+    // Owned by the preprocess task; the monitor only reads its statistics
+    rt::StereoSynchronizer stereoSync({std::chrono::nanoseconds(STEREO_SKEW_WINDOW_NS)});
+    
+    // Skip detection while neither camera sees anything move; also owned
+    // by the preprocess task
+    rt::MotionGate leftMotion(rt::MotionGate::Config{});
+    rt::MotionGate rightMotion(rt::MotionGate::Config{});
+    
+    // Crop boxes the detection task's merger dropped for capacity so far;
+    // read by the monitor
+    std::atomic<std::uint64_t> droppedCropBoxes{0};
+    
+    // Set by preprocess when the gates found the latest pair unchanged;
+    // the display then holds its tracks instead of extrapolating them
+    std::atomic<bool> sceneStatic{false};
 }
 
 void signal_handler(int signal) {
@@ -77,6 +270,62 @@ struct XenomaiTask {
     }
 };
 
+// Every input size the detector reserves, by level
+std::vector<cv::Size> detectorLevels() {
+    std::vector<cv::Size> sizes{CROP_INPUT};
+    sizes.insert(sizes.end(), DETECTOR_INPUTS.begin(), DETECTOR_INPUTS.end());
+    return sizes;
+}
+
+std::size_t fullFrameLevel(std::size_t inputLevel) {
+    return CROP_LEVEL + 1 + inputLevel;
+}
+
+// One fused preprocessing kernel per detector level
+std::vector<rt::BlobKernel> createInputKernels() {
+    std::vector<rt::BlobKernel> kernels;
+    for (const cv::Size& size : detectorLevels()) {
+        kernels.emplace_back(size);
+    }
+    return kernels;
+}
+
+rt::TilePlanner createTilePlanner() {
+    rt::TilePlanner::Config config;
+    config.overlap = TILE_OVERLAP;
+    config.maxTiles = MAX_TILES;
+    return rt::TilePlanner(config);
+}
+
+// Images one pass runs at each detector level, so the warm-up shapes every
+// net for the batch it will actually see. Crop passes always run
+// MAX_REGIONS images per eye; the crop level is unused outside tracked
+// per-eye detection and is only warmed at one image.
+std::vector<int> detectorBatches(const rt::StereoCaptureSystem& system, RegionLayout layout,
+                                 bool detectRightEye) {
+    const int eyes = detectRightEye ? NUM_EYES : 1;
+    const bool crops = PREPROCESS_MODE == PreprocessMode::PerEye &&
+                       layout == RegionLayout::Tracked;
+    const rt::TilePlanner tiler = createTilePlanner();
+    std::vector<cv::Rect> tiles;
+    std::vector<int> batches{crops ? eyes * MAX_REGIONS : 1};
+    for (const cv::Size& size : DETECTOR_INPUTS) {
+        if (PREPROCESS_MODE == PreprocessMode::Merged) {
+            batches.push_back(1);
+        } else if (layout == RegionLayout::Tiled) {
+            int count = 0;
+            for (int eye = 0; eye < eyes; ++eye) {
+                tiler.plan(system.frameSize(eye == LEFT_EYE), size, tiles);
+                count += static_cast<int>(tiles.size());
+            }
+            batches.push_back(count);
+        } else {
+            batches.push_back(eyes);
+        }
+    }
+    return batches;
+}
+
 // Task entry points
 void leftCameraTask(void* cookie) {
     auto* system = static_cast<rt::StereoCaptureSystem*>(cookie);
@@ -86,15 +335,28 @@ void leftCameraTask(void* cookie) {
     rt_task_set_periodic(NULL, TM_NOW, CAPTURE_PERIOD_NS);
     spdlog::info("Started left camera task on CPU {}", info.cpuid);
     
+    const bool triggered = CAPTURE_MODE == CaptureMode::Triggered;
     while (!gSignalStatus) {
         rt_task_wait_period(NULL);
         RTIME start = rt_timer_read();
         
-        cv::Mat leftFrame;
-        if (system->captureLeftFrame(leftFrame)) {
-            rt_mutex_acquire(&frameMutex, TM_INFINITE);
-            system->updateMergedView(leftFrame, true);
-            rt_mutex_release(&frameMutex);
+        // The trigger point: the right task decodes its half of the pair
+        // while this one decodes the left. No trigger while the right task
+        // is still on the previous pair; grabPair() counts those.
+        if (triggered) {
+            if (!system->grabPair()) {
+                continue;
+            }
+            rt_sem_v(&rightRetrieve);
+        }
+        
+        // Capture straight into a pooled frame; drop it if the preprocess
+        // stage still owns every queue slot
+        rt::FramePool::Handle* leftFrame = leftFrames.beginWrite();
+        if (leftFrame && (triggered ? system->retrieveLeftFrame(*leftFrame)
+                                    : system->captureLeftFrame(*leftFrame))) {
+            leftFrames.commitWrite();
+            rt_sem_broadcast(&preprocessSync);
         }
         
         RTIME end = rt_timer_read();
@@ -109,19 +371,28 @@ void rightCameraTask(void* cookie) {
     RT_TASK_INFO info;
     rt_task_inquire(NULL, &info);
     
-    rt_task_set_periodic(NULL, TM_NOW, CAPTURE_PERIOD_NS);
+    // Triggered, the left camera task sets the pace
+    const bool triggered = CAPTURE_MODE == CaptureMode::Triggered;
+    if (!triggered) {
+        rt_task_set_periodic(NULL, TM_NOW, CAPTURE_PERIOD_NS);
+    }
     spdlog::info("Started right camera task on CPU {}", info.cpuid);
     
     while (!gSignalStatus) {
-        rt_task_wait_period(NULL);
+        if (!triggered) {
+            rt_task_wait_period(NULL);
+        } else if (rt_sem_p(&rightRetrieve, TM_INFINITE) != 0 || gSignalStatus) {
+            break;
+        }
         RTIME start = rt_timer_read();
         
-        cv::Mat rightFrame;
-        if (system->captureRightFrame(rightFrame)) {
-            rt_mutex_acquire(&frameMutex, TM_INFINITE);
-            system->updateMergedView(rightFrame, false);
-            rt_mutex_release(&frameMutex);
+        rt::FramePool::Handle* rightFrame = rightFrames.beginWrite();
+        if (rightFrame && (triggered ? system->retrieveRightFrame(*rightFrame)
+                                     : system->captureRightFrame(*rightFrame))) {
+            rightFrames.commitWrite();
             rt_sem_broadcast(&preprocessSync);
+        } else if (!rightFrame && triggered) {
+            system->skipRightFrame();  // Lets the next trigger go ahead
         }
         
         RTIME end = rt_timer_read();
@@ -131,32 +402,250 @@ void rightCameraTask(void* cookie) {
     }
 }
 
+// Lays out one eye's crops in a crop pass, each in a whole image of its own
+void planCrops(const std::vector<cv::Rect>& crops, const cv::Size& inputSize,
+               DetectionInput& input, int eye) {
+    input.first[eye] = input.numRegions;
+    for (const cv::Rect& crop : crops) {
+        rt::RegionInput& region = input.regions[input.numRegions++];
+        region.roi = crop;
+        region.image = input.numInputs++;
+        region.cell = cv::Rect(cv::Point(), inputSize);
+    }
+    input.count[eye] = input.numRegions - input.first[eye];
+}
+
+// Lays out one eye's image in a full-size input: the full frame, or when
+// the eye has crops but the other eye needs a full frame, the crops as
+// cells of a mosaic
+void planFullInput(const std::vector<cv::Rect>& crops, const cv::Size& frameSize,
+                   const cv::Size& inputSize, std::vector<cv::Rect>& cells,
+                   DetectionInput& input, int eye) {
+    input.first[eye] = input.numRegions;
+    if (!crops.empty()) {
+        rt::planMosaic(inputSize, static_cast<int>(crops.size()), cells);
+        for (std::size_t i = 0; i < crops.size(); ++i) {
+            rt::RegionInput& region = input.regions[input.numRegions++];
+            region.roi = crops[i];
+            region.image = input.numInputs;
+            region.cell = cells[i];
+        }
+    } else {
+        rt::RegionInput& region = input.regions[input.numRegions++];
+        region.roi = cv::Rect(cv::Point(), frameSize);
+        region.image = input.numInputs;
+        region.cell = cv::Rect(cv::Point(), inputSize);
+    }
+    ++input.numInputs;
+    input.count[eye] = input.numRegions - input.first[eye];
+}
+
+// Lays out one eye's images in input as a grid of tiles at the network
+// input size, one image each
+void planTiles(const rt::TilePlanner& planner, const cv::Size& frameSize, const cv::Size& tileSize,
+               std::vector<cv::Rect>& tiles, DetectionInput& input, int eye) {
+    planner.plan(frameSize, tileSize, tiles);
+    input.first[eye] = input.numRegions;
+    for (const cv::Rect& tile : tiles) {
+        rt::RegionInput& region = input.regions[input.numRegions++];
+        region.roi = tile;
+        region.image = input.numInputs++;
+        region.cell = cv::Rect(cv::Point(), tileSize);
+    }
+    input.count[eye] = input.numRegions - input.first[eye];
+}
+
+// Letterboxes every region of one eye straight into its cell of the
+// detector's tensor
+void preprocessRegions(rt::BlobKernel& kernel, const cv::Mat& frame, rt::YOLODetector& detector,
+                       DetectionInput& input, int eye) {
+    for (int index = input.first[eye]; index < input.first[eye] + input.count[eye]; ++index) {
+        rt::RegionInput& region = input.regions[index];
+        region.transform = kernel.letterbox(frame(region.roi),
+                                            detector.inputImage(input.tensor, region.image),
+                                            region.cell);
+    }
+}
+
+// What the preprocess stage works between: frames come from the capture
+// system and network inputs go straight into the detector's tensors
+struct PreprocessContext {
+    rt::StereoCaptureSystem* system;
+    rt::YOLODetector* detector;
+    RegionLayout layout;
+    bool detectRightEye;  // false when right boxes are projected from the left
+};
+
 void preprocessTask(void* cookie) {
+    auto* context = static_cast<PreprocessContext*>(cookie);
+    auto* system = context->system;
+    auto* detector = context->detector;
+    const RegionLayout layout = context->layout;
+    const bool detectRightEye = context->detectRightEye;
     RT_TASK_INFO info;
     rt_task_inquire(NULL, &info);
     
     rt_task_set_periodic(NULL, TM_NOW, PREPROCESS_PERIOD_NS);
     spdlog::info("Started preprocess task on CPU {}", info.cpuid);
     
+    // Fused resize/colour/normalize straight into the blobs; the kernel's
+    // sampling tables are owned by this task only
+    std::vector<rt::BlobKernel> leftEyes = createInputKernels();
+    rt::StereoSynchronizer::StereoPair pair;
+    int pairsSinceInput = 0;
+    
+    rt::RoiPlanner::Config roiConfig;
+    roiConfig.maxRegions = MAX_REGIONS;
+    roiConfig.maxKnown = MAX_DETECTIONS;
+    std::array<rt::RoiPlanner, NUM_EYES> planners{rt::RoiPlanner(roiConfig),
+                                                  rt::RoiPlanner(roiConfig)};
+    const rt::TilePlanner tiler = createTilePlanner();
+    std::array<std::vector<cv::Rect>, NUM_EYES> crops;
+    for (auto& eye : crops) {
+        eye.reserve(MAX_DETECTIONS);
+    }
+    std::vector<cv::Rect> cells;
+    cells.reserve(MAX_REGIONS);
+    spdlog::info("Preprocess kernels use {}", rt::toString(leftEyes.front().simdLevel()));
+    
     while (!gSignalStatus) {
         rt_task_wait_period(NULL);
         RTIME start = rt_timer_read();
         
         if (rt_sem_p(&preprocessSync, TM_INFINITE) == 0) {
-            rt_mutex_acquire(&frameMutex, TM_INFINITE);
-            cv::Mat localFrame = mergedFrame.clone();
-            rt_mutex_release(&frameMutex);
+            // Move every captured frame into the synchronizer
+            while (rt::FramePool::Handle* frame = leftFrames.front()) {
+                stereoSync.pushLeft(std::move(*frame));
+                leftFrames.pop();
+            }
+            while (rt::FramePool::Handle* frame = rightFrames.front()) {
+                stereoSync.pushRight(std::move(*frame));
+                rightFrames.pop();
+            }
+            
+            // Only the freshest matched pair is worth preprocessing
+            const bool matched = stereoSync.tryMatchNewest(pair);
             
-            // Preprocess frame
-            cv::Mat processed;
-            cv::resize(localFrame, processed, cv::Size(416, 416));
-            cv::cvtColor(processed, processed, cv::COLOR_BGR2RGB);
-            processed.convertTo(processed, CV_32F, 1.0/255);
+            const bool due = matched && ++pairsSinceInput >= DETECTION_INTERVAL;
+            if (matched) {
+                system->updateMergedView(pair.left.frame(), true);
+                system->updateMergedView(pair.right.frame(), false);
+            }
             
-            rt_mutex_acquire(&frameMutex, TM_INFINITE);
-            preprocessedFrame = processed;
-            rt_mutex_release(&frameMutex);
-            rt_sem_broadcast(&detectionSync);
+            bool moved = false;
+            if (due) {
+                // Both gates see every pair so their thumbnails stay current
+                const bool leftMoved = leftMotion.check(pair.left.frame());
+                const bool rightMoved = rightMotion.check(pair.right.frame());
+                moved = leftMoved || rightMoved;
+                sceneStatic.store(!moved, std::memory_order_relaxed);
+                if (!moved) {
+                    // Static scene: the display keeps the last detections
+                    leftMotion.skip();
+                    rightMotion.skip();
+                }
+            }
+            DetectionInput* input = moved ? detectionInputs.beginWrite() : nullptr;
+            
+            if (input) {
+                std::size_t level = fullFrameLevel(inputLevel.load(std::memory_order_relaxed));
+                
+                // Crops run at the small crop level only when every detected
+                // eye has them; a full frame in either eye keeps full size
+                bool cropPass = PREPROCESS_MODE == PreprocessMode::PerEye &&
+                                layout == RegionLayout::Tracked;
+                if (cropPass) {
+                    knownObjects.update();
+                    const KnownObjects& known = knownObjects.front();
+                    for (int eye = 0; eye < NUM_EYES; ++eye) {
+                        crops[eye].clear();
+                        if (eye == LEFT_EYE || detectRightEye) {
+                            const cv::Size frameSize = (eye == LEFT_EYE ? pair.left : pair.right).frame().size();
+                            cropPass &= planners[eye].plan(known.eyes[eye], frameSize, crops[eye]);
+                        }
+                    }
+                    if (cropPass) {
+                        level = CROP_LEVEL;
+                    }
+                }
+                rt::BlobKernel& leftEye = leftEyes[level];
+                detector->setInputResolution(input->tensor, level);
+                
+                if (PREPROCESS_MODE == PreprocessMode::PerEye) {
+                    input->numRegions = 0;
+                    input->numInputs = 0;
+                    for (int eye = 0; eye < NUM_EYES; ++eye) {
+                        const cv::Size frameSize = (eye == LEFT_EYE ? pair.left : pair.right).frame().size();
+                        if (eye == RIGHT_EYE && !detectRightEye) {
+                            input->first[eye] = input->numRegions;
+                            input->count[eye] = 0;
+                        } else if (layout == RegionLayout::Tiled) {
+                            planTiles(tiler, frameSize, leftEye.inputSize(), crops[eye], *input, eye);
+                        } else if (cropPass) {
+                            planCrops(crops[eye], leftEye.inputSize(), *input, eye);
+                        } else {
+                            planFullInput(crops[eye], frameSize, leftEye.inputSize(), cells,
+                                          *input, eye);
+                        }
+                    }
+                    if (cropPass) {
+                        // The batch the crop level was warmed at; spare
+                        // images run too, but no region reads them
+                        input->numInputs = (detectRightEye ? NUM_EYES : 1) * MAX_REGIONS;
+                    }
+                    
+                    // Right eye runs on the helper task's core meanwhile
+                    const bool rightImages = input->count[RIGHT_EYE] > 0;
+                    if (rightImages) {
+                        rightEyeJob.frame = &pair.right.frame();
+                        rightEyeJob.input = input;
+                        rightEyeJob.level = level;
+                        rt_sem_v(&rightEyeStart);
+                    }
+                    
+                    preprocessRegions(leftEye, pair.left.frame(), *detector, *input, LEFT_EYE);
+                    
+                    if (rightImages) {
+                        rt_sem_p(&rightEyeDone, TM_INFINITE);
+                    }
+                } else {
+                    // Resize each eye into its half of the network input, which
+                    // is the same image as squashing the side-by-side view
+                    float* leftTensor = detector->inputImage(input->tensor, 0);
+                    const cv::Size size = leftEye.inputSize();
+                    const int halfWidth = size.width / 2;
+                    leftEye.resize(pair.left.frame(), leftTensor,
+                                   cv::Rect(0, 0, halfWidth, size.height));
+                    leftEye.resize(pair.right.frame(), leftTensor,
+                                   cv::Rect(halfWidth, 0, size.width - halfWidth, size.height));
+                    input->numInputs = 1;
+                    input->first = {0, 1};
+                    input->count = {1, 0};
+                }
+                
+                // Later pairs are compared with the ones detected here
+                leftMotion.accept();
+                rightMotion.accept();
+                pairsSinceInput = 0;
+                
+                // The pair stays with its input until distances are known
+                input->left = std::move(pair.left);
+                input->right = std::move(pair.right);
+                input->taken = rt_timer_read();
+                
+                detectionInputs.commitWrite();
+                if (DETECTION_MODE == DetectionMode::Pipelined) {
+                    rt_sem_v(&detectionSync);  // Counted, so no hand-over is missed
+                } else {
+                    rt_sem_broadcast(&detectionSync);
+                }
+            } else {
+                // No input took the pair (static scene, or detection holds
+                // every slot): hand its frames back to the pools now rather
+                // than at the next match
+                pair.left.reset();
+                pair.right.reset();
+            }
         }
         
         RTIME end = rt_timer_read();
@@ -166,28 +655,178 @@ void preprocessTask(void* cookie) {
     }
 }
 
-void detectionTask(void* cookie) {
+// Preprocesses the right eye on its own core whenever the preprocess task
+// hands over a job, so both eyes are letterboxed in parallel
+void rightEyePreprocessTask(void* cookie) {
     auto* detector = static_cast<rt::YOLODetector*>(cookie);
     RT_TASK_INFO info;
     rt_task_inquire(NULL, &info);
+    spdlog::info("Started right eye preprocess task on CPU {}", info.cpuid);
+    
+    std::vector<rt::BlobKernel> rightEyes = createInputKernels();
+    
+    while (!gSignalStatus) {
+        if (rt_sem_p(&rightEyeStart, TM_INFINITE) != 0) {
+            continue;
+        }
+        if (!gSignalStatus) {
+            preprocessRegions(rightEyes[rightEyeJob.level], *rightEyeJob.frame, *detector,
+                              *rightEyeJob.input, RIGHT_EYE);
+        }
+        // Answer every start, even one skipped for shutdown, or the
+        // preprocess task would wait for rightEyeDone forever
+        rt_sem_v(&rightEyeDone);
+    }
+}
+
+using ImageDetections = std::array<std::vector<rt::YOLODetector::DetectionResult>, MAX_IMAGES>;
+
+// Brings one pair's per-image detections into camera pixels, one list per
+// eye, and attaches distances when a depth stage is given. Eyes the input
+// did not use come back empty. Hands the pair's frames back to the pools.
+void finishDetections(DetectionInput& input, ImageDetections& images,
+                      rt::RegionMerger& merger, rt::DepthEstimator* depth,
+                      std::array<std::vector<rt::YOLODetector::DetectionResult>, NUM_EYES>& eyes) {
+    if (PREPROCESS_MODE == PreprocessMode::Merged) {
+        // A single image whose boxes stay in network input pixels
+        eyes[LEFT_EYE].swap(images[0]);
+        eyes[RIGHT_EYE].clear();
+    } else {
+        // Crops and tiles of one eye can see the same object twice
+        for (int eye = 0; eye < NUM_EYES; ++eye) {
+            merger.merge(images.data(), input.regions.data() + input.first[eye],
+                         input.count[eye], REGION_MERGE_IOU, eyes[eye]);
+        }
+        droppedCropBoxes.store(merger.droppedCandidates(), std::memory_order_relaxed);
+        
+        // Block matching only inside the boxes. When the network skipped
+        // the right eye, its boxes come from searching the left ones there.
+        if (depth && input.left && input.right) {
+            if (input.count[RIGHT_EYE] == 0) {
+                depth->project(input.left.frame(), input.right.frame(),
+                               eyes[LEFT_EYE], eyes[RIGHT_EYE]);
+            } else {
+                depth->estimate(input.left.frame(), input.right.frame(),
+                                rt::DepthEstimator::Eye::Left, eyes[LEFT_EYE]);
+                depth->estimate(input.left.frame(), input.right.frame(),
+                                rt::DepthEstimator::Eye::Right, eyes[RIGHT_EYE]);
+            }
+        }
+    }
+    
+    input.left.reset();
+    input.right.reset();
+}
+
+// Feeds one pass's inference time to the full-frame resolution choice.
+// Crop passes run a size and batch of their own, so they do not count.
+void recordPassTime(rt::ResolutionController& resolution, std::chrono::nanoseconds elapsed,
+                    std::size_t level) {
+    if (level != CROP_LEVEL) {
+        inputLevel.store(resolution.update(elapsed, level - fullFrameLevel(0)),
+                         std::memory_order_relaxed);
+    }
+}
+
+struct DetectionContext {
+    rt::YOLODetector* detector;
+    rt::AsyncDetector* asyncDetector;
+    rt::DepthEstimator* depth;  // null without a calibrated rig
+};
+
+void detectionTask(void* cookie) {
+    auto* context = static_cast<DetectionContext*>(cookie);
+    auto* detector = context->detector;
+    auto* asyncDetector = context->asyncDetector;
+    auto* depth = context->depth;
+    RT_TASK_INFO info;
+    rt_task_inquire(NULL, &info);
     
-    rt_task_set_periodic(NULL, TM_NOW, DETECTION_PERIOD_NS);
+    // Pipelined detection is event driven instead: preprocess posts
+    // detectionSync when it commits an input and the worker when it
+    // finishes one, so a ready input is submitted at once
+    if (DETECTION_MODE == DetectionMode::Blocking) {
+        rt_task_set_periodic(NULL, TM_NOW, DETECTION_PERIOD_NS);
+    }
     spdlog::info("Started detection task on CPU {}", info.cpuid);
     
+    // Sink for results when the display stage still holds every slot
+    StereoDetections dropped;
+    for (auto& eye : dropped.eyes) {
+        eye.reserve(MAX_DETECTIONS);
+    }
+    
+    // Inference has to fit the detection period; trade resolution for it
+    rt::ResolutionController resolution({std::chrono::nanoseconds(DETECTION_PERIOD_NS)},
+                                        DETECTOR_INPUTS);
+    
+    // Per-image results before crops are merged back into their eye
+    ImageDetections images;
+    for (auto& image : images) {
+        image.reserve(MAX_DETECTIONS);
+    }
+    rt::RegionMerger merger(MAX_IMAGES_PER_EYE * MAX_DETECTIONS);
+    
     while (!gSignalStatus) {
-        rt_task_wait_period(NULL);
+        if (DETECTION_MODE == DetectionMode::Pipelined) {
+            if (rt_sem_p(&detectionSync, TM_INFINITE) != 0 || gSignalStatus) {
+                continue;
+            }
+        } else {
+            rt_task_wait_period(NULL);
+        }
         RTIME start = rt_timer_read();
         
-        if (rt_sem_p(&detectionSync, TM_INFINITE) == 0) {
-            rt_mutex_acquire(&frameMutex, TM_INFINITE);
-            cv::Mat frameCopy = preprocessedFrame.clone();
-            rt_mutex_release(&frameMutex);
+        if (DETECTION_MODE == DetectionMode::Pipelined) {
+            // Never waits for the network: collect the pair that finished,
+            // whose input is still at the front of the ring...
+            if (asyncDetector->ready()) {
+                DetectionInput* input = detectionInputs.front();
+                StereoDetections* slot = detectionResults.beginWrite();
+                auto& eyes = slot ? slot->eyes : dropped.eyes;
+                
+                asyncDetector->poll(images.data());
+                recordPassTime(resolution, asyncDetector->runTime(),
+                               detector->inputResolution(input->tensor));
+                finishDetections(*input, images, merger, depth, eyes);
+                
+                if (slot) {
+                    slot->taken = input->taken;
+                    detectionResults.commitWrite();
+                }
+                detectionInputs.pop();
+            }
             
-            auto results = detector->detect(frameCopy);
+            // ...then hand the worker the newest pair. Its tensor stays in
+            // the ring until polled, while preprocess fills the next slot.
+            if (!asyncDetector->busy()) {
+                detectionInputs.dropStale();
+                if (DetectionInput* input = detectionInputs.front()) {
+                    asyncDetector->submit(input->tensor, input->numInputs);
+                    rt_sem_v(&inferenceStart);
+                }
+            }
+        } else if (rt_sem_p(&detectionSync, TM_INFINITE) == 0) {
+            detectionInputs.dropStale();
             
-            rt_mutex_acquire(&frameMutex, TM_INFINITE);
-            detectionResults = results;
-            rt_mutex_release(&frameMutex);
+            if (DetectionInput* input = detectionInputs.front()) {
+                StereoDetections* slot = detectionResults.beginWrite();
+                
+                auto& eyes = slot ? slot->eyes : dropped.eyes;
+                
+                // One forward pass for every image of the pair
+                RTIME inferStart = rt_timer_read();
+                detector->detectBatch(input->tensor, input->numInputs, images.data());
+                const std::chrono::nanoseconds elapsed(rt_timer_read() - inferStart);
+                recordPassTime(resolution, elapsed, detector->inputResolution(input->tensor));
+                finishDetections(*input, images, merger, depth, eyes);
+                
+                if (slot) {
+                    slot->taken = input->taken;
+                    detectionResults.commitWrite();
+                }
+                detectionInputs.pop();
+            }
         }
         
         RTIME end = rt_timer_read();
@@ -197,7 +836,24 @@ void detectionTask(void* cookie) {
     }
 }
 
+// Runs the forward passes the detection task submits, so inference and
+// postprocessing of one pair overlap with preprocessing of the next
+void inferenceTask(void* cookie) {
+    auto* asyncDetector = static_cast<rt::AsyncDetector*>(cookie);
+    RT_TASK_INFO info;
+    rt_task_inquire(NULL, &info);
+    spdlog::info("Started inference task on CPU {}", info.cpuid);
+    
+    while (!gSignalStatus) {
+        if (rt_sem_p(&inferenceStart, TM_INFINITE) == 0 && !gSignalStatus) {
+            asyncDetector->runPending();
+            rt_sem_v(&detectionSync);  // Results are ready to poll
+        }
+    }
+}
+
 void monitorTask(void* cookie) {
+    auto* system = static_cast<rt::StereoCaptureSystem*>(cookie);
     RT_TASK_INFO info;
     rt_task_inquire(NULL, &info);
     
@@ -226,6 +882,30 @@ void monitorTask(void* cookie) {
             double missRate = (double)missedDeadlines / totalCycles * 100.0;
             spdlog::info("Performance: Cycles={}, Missed={}, Rate={:.2f}%",
                         totalCycles, missedDeadlines, missRate);
+            
+            auto syncStats = stereoSync.getStats();
+            spdlog::info("Stereo: Pairs={}, Skipped={}, DroppedL={}, DroppedR={}, "
+                        "Skew={:.2f}ms, MaxSkew={:.2f}ms",
+                        syncStats.matchedPairs, syncStats.skippedPairs,
+                        syncStats.droppedLeft, syncStats.droppedRight,
+                        syncStats.lastSkew.count()/1000000.0,
+                        syncStats.maxSkew.count()/1000000.0);
+            if (CAPTURE_MODE == CaptureMode::Triggered) {
+                auto grabStats = system->getGrabStats();
+                spdlog::info("Grab: Pairs={}, Skipped={}, Skew={:.1f}us, MaxSkew={:.1f}us",
+                            grabStats.pairs, grabStats.skippedTriggers,
+                            grabStats.lastSkew.count()/1000.0,
+                            grabStats.maxSkew.count()/1000.0);
+            }
+            
+            auto leftStats = leftMotion.stats();
+            auto rightStats = rightMotion.stats();
+            spdlog::info("Motion: Frames={}, Skipped={}/{}",
+                        leftStats.frames, leftStats.skipped, rightStats.skipped);
+            
+            const cv::Size input = DETECTOR_INPUTS[inputLevel.load(std::memory_order_relaxed)];
+            spdlog::info("Detector input: {}x{}, dropped crop boxes={}", input.width,
+                        input.height, droppedCropBoxes.load(std::memory_order_relaxed));
         }
         
         RTIME end = rt_timer_read();
@@ -235,46 +915,273 @@ void monitorTask(void* cookie) {
     }
 }
 
+// Where the display task sends its output: the terminal always, and an
+// annotated side-by-side video when a record path is given
+struct DisplayContext {
+    rt::StereoCaptureSystem* system;
+    std::string recordPath;
+};
+
+// Draws the confirmed tracks of each eye onto the side-by-side view
+void drawTracks(const std::array<rt::ObjectTracker, NUM_EYES>& trackers, int eyeWidth,
+                cv::Mat& view) {
+    const cv::Scalar color(0, 0, 255);
+    for (int eye = 0; eye < NUM_EYES; ++eye) {
+        const cv::Point offset(eye == LEFT_EYE ? 0 : eyeWidth, 0);
+        for (const auto& track : trackers[eye].tracks()) {
+            if (!track.confirmed) {
+                continue;
+            }
+            cv::rectangle(view, track.box + offset, color, 2);
+            cv::putText(view, track.className, track.box.tl() + offset - cv::Point(0, 4),
+                        cv::FONT_HERSHEY_SIMPLEX, 0.5, color, 1);
+        }
+    }
+}
+
 void displayTask(void* cookie) {
+    auto* context = static_cast<DisplayContext*>(cookie);
     RT_TASK_INFO info;
     rt_task_inquire(NULL, &info);
     
     rt_task_set_periodic(NULL, TM_NOW, DISPLAY_PERIOD_NS);
     spdlog::info("Started display task on CPU {}", info.cpuid);
     
+    StereoDetections localResults;
+    for (auto& eye : localResults.eyes) {
+        eye.reserve(MAX_DETECTIONS);
+    }
+    
+    // Runs at capture rate and keeps objects moving between detections
+    rt::ObjectTracker::Config trackerConfig;
+    trackerConfig.maxMisses = TRACK_MAX_MISSES;
+    trackerConfig.maxDetections = MAX_DETECTIONS;
+    std::array<rt::ObjectTracker, NUM_EYES> trackers{rt::ObjectTracker(trackerConfig),
+                                                     rt::ObjectTracker(trackerConfig)};
+    
+    // Recording annotates a copy of the newest merged view, so the capture
+    // path and the detector never see the overlay
+    const cv::Size leftSize = context->system->frameSize(true);
+    const cv::Size rightSize = context->system->frameSize(false);
+    const rt::StereoOverlay overlay(leftSize.width, leftSize.height);
+    cv::VideoWriter recorder;
+    cv::Mat view;
+    if (!context->recordPath.empty()) {
+        const double fps = 1e9 / DISPLAY_PERIOD_NS;
+        recorder.open(context->recordPath, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), fps,
+                      cv::Size(leftSize.width + rightSize.width, leftSize.height));
+        if (!recorder.isOpened()) {
+            spdlog::error("Cannot record to {}", context->recordPath);
+        }
+    }
+    
     while (!gSignalStatus) {
         rt_task_wait_period(NULL);
         
-        rt_mutex_acquire(&frameMutex, TM_INFINITE);
-        auto localResults = detectionResults;
-        rt_mutex_release(&frameMutex);
+        if (!sceneStatic.load(std::memory_order_relaxed)) {
+            for (auto& tracker : trackers) {
+                tracker.predict();
+            }
+        }
+        
+        // Take over the newest result vector; the slot keeps our old storage
+        detectionResults.dropStale();
+        if (auto* latest = detectionResults.front()) {
+            std::swap(localResults, *latest);
+            detectionResults.pop();
+            // The tracks are already predicted to now; match the detections
+            // where the tracks were when their pair was taken
+            const float age = static_cast<float>(rt_timer_read() - localResults.taken) /
+                              DISPLAY_PERIOD_NS;
+            for (int eye = 0; eye < NUM_EYES; ++eye) {
+                trackers[eye].update(localResults.eyes[eye], age);
+            }
+        }
+        
+        // Where the next detections should look
+        KnownObjects& known = knownObjects.back();
+        for (int eye = 0; eye < NUM_EYES; ++eye) {
+            known.eyes[eye].clear();
+            for (const auto& track : trackers[eye].tracks()) {
+                if (track.confirmed) {
+                    known.eyes[eye].push_back(track.box);
+                }
+            }
+        }
+        knownObjects.publish();
+        
+        if (recorder.isOpened()) {
+            context->system->getMergedFrame().copyTo(view);
+            overlay.apply(view);
+            // Merged-mode boxes are in network input pixels, not the view's
+            if (PREPROCESS_MODE == PreprocessMode::PerEye) {
+                drawTracks(trackers, leftSize.width, view);
+            }
+            recorder.write(view);
+        }
         
         // Display results in terminal
         std::cout << "\033[2J\033[1;1H";  // Clear screen
         std::cout << "Detection Results:\n";
         std::cout << "================\n";
-        for (const auto& det : localResults) {
-            std::cout << fmt::format("Object: {}, Confidence: {:.2f}, Box: ({}, {}, {}, {})\n",
-                det.className, det.confidence,
-                det.box.x, det.box.y, det.box.width, det.box.height);
+        for (int eye = 0; eye < NUM_EYES; ++eye) {
+            const char* source = PREPROCESS_MODE == PreprocessMode::Merged ? "Merged"
+                               : eye == LEFT_EYE ? "Left" : "Right";
+            for (const auto& track : trackers[eye].tracks()) {
+                if (!track.confirmed) {
+                    continue;
+                }
+                std::cout << fmt::format("[{}] Track {}: {}, Confidence: {:.2f}, Box: ({}, {}, {}, {})",
+                    source, track.id, track.className, track.confidence,
+                    track.box.x, track.box.y, track.box.width, track.box.height);
+                if (track.distance > 0.0f) {
+                    std::cout << fmt::format(", Distance: {:.2f}", track.distance);
+                }
+                std::cout << '\n';
+            }
+        }
+    }
+}
+
+// The stage rings and the synchronizer are globals, but the frames they
+// hold belong to the capture system's pools, which main destroys first.
+// Hands every frame back while the pools exist; every task must be joined.
+void releaseFrames() {
+    auto release = [](rt::FramePool::Handle& frame) { frame.reset(); };
+    leftFrames.forEachSlot(release);
+    rightFrames.forEachSlot(release);
+    detectionInputs.forEachSlot([](DetectionInput& input) {
+        input.left.reset();
+        input.right.reset();
+    });
+    stereoSync.clear();
+}
+
+// Rectification tables for the calibrated rig, or null (logged) when
+// there is no usable calibration
+std::shared_ptr<const rt::StereoRectifier> createRectifier() {
+    try {
+        const rt::StereoCalibration calibration = rt::StereoCalibration::load(STEREO_CALIBRATION);
+        const cv::Size left(LEFT_CAMERA.width, LEFT_CAMERA.height);
+        const cv::Size right(RIGHT_CAMERA.width, RIGHT_CAMERA.height);
+        if (calibration.imageSize() != left || calibration.imageSize() != right) {
+            spdlog::warn("Rectification disabled: calibration is for {}x{} frames",
+                         calibration.imageSize().width, calibration.imageSize().height);
+            return nullptr;
         }
+        spdlog::info("Rectifying to {}x{}: baseline {:.3f}, focal length {:.1f}px",
+                     RECTIFIED_SIZE.width, RECTIFIED_SIZE.height,
+                     calibration.baseline(), calibration.focalLength());
+        return rt::StereoRectifier::create(calibration, RECTIFIED_SIZE, RECTIFICATION_CACHE);
+    } catch (const std::exception& e) {
+        spdlog::warn("Rectification disabled: {}", e.what());
+        return nullptr;
     }
 }
 
-int main() {
+// Run options, accepted in any order:
+//   --replay <left> <right>  recorded sequences instead of the live cameras
+//   --fast                   replay as fast as the pipeline consumes frames
+//   --tiled                  native-scale tiles, trading throughput for
+//                            small-object recall
+//   --record <path>          annotated stereo video of the run
+struct CommandLine {
+    std::string replayLeft;   // empty for live cameras
+    std::string replayRight;
+    bool fast = false;
+    RegionLayout layout = RegionLayout::Tracked;
+    std::string recordPath;
+};
+
+CommandLine parseCommandLine(int argc, char** argv) {
+    CommandLine options;
+    auto requireOperands = [&](int arg, int count) {
+        if (arg + count >= argc) {
+            throw std::invalid_argument(std::string(argv[arg]) + " needs " +
+                                        std::to_string(count) + " argument(s)");
+        }
+    };
+    for (int arg = 1; arg < argc; ++arg) {
+        if (std::strcmp(argv[arg], "--replay") == 0) {
+            requireOperands(arg, 2);
+            options.replayLeft = argv[++arg];
+            options.replayRight = argv[++arg];
+        } else if (std::strcmp(argv[arg], "--fast") == 0) {
+            options.fast = true;
+        } else if (std::strcmp(argv[arg], "--tiled") == 0) {
+            options.layout = RegionLayout::Tiled;
+        } else if (std::strcmp(argv[arg], "--record") == 0) {
+            requireOperands(arg, 1);
+            options.recordPath = argv[++arg];
+        } else {
+            throw std::invalid_argument(std::string("Unknown option ") + argv[arg]);
+        }
+    }
+    if (options.fast && options.replayLeft.empty()) {
+        throw std::invalid_argument("--fast only applies to --replay");
+    }
+    return options;
+}
+
+// Live cameras by default, or the recorded sequences given with --replay
+std::unique_ptr<rt::StereoCaptureSystem> createCaptureSystem(
+    const CommandLine& options, std::shared_ptr<const rt::StereoRectifier> rectifier) {
+    if (options.replayLeft.empty()) {
+        // Rectification remaps every pixel on the capture core anyway;
+        // packed frames would add a full conversion and a copy to it
+        rt::StereoCaptureSystem::CameraConfig left = LEFT_CAMERA;
+        rt::StereoCaptureSystem::CameraConfig right = RIGHT_CAMERA;
+        if (rectifier) {
+            left.format = right.format = rt::PixelFormat::BGR;
+        }
+        return std::make_unique<rt::StereoCaptureSystem>(left, right, std::move(rectifier));
+    }
+    
+    const bool fast = options.fast;
+    auto replay = [fast](const std::string& path,
+                         const rt::StereoCaptureSystem::CameraConfig& camera) {
+        rt::ReplayFrameSource::Config config;
+        config.path = path;
+        config.width = camera.width;
+        config.height = camera.height;
+        config.fps = camera.fps;
+        config.pacing = fast ? rt::ReplayFrameSource::Pacing::AsFastAsPossible
+                             : rt::ReplayFrameSource::Pacing::RealTime;
+        config.loop = true;
+        return std::make_unique<rt::ReplayFrameSource>(config);
+    };
+    
+    // Recordings hold BGR frames whatever the cameras deliver live
+    rt::StereoCaptureSystem::CameraConfig left = LEFT_CAMERA;
+    rt::StereoCaptureSystem::CameraConfig right = RIGHT_CAMERA;
+    left.format = right.format = rt::PixelFormat::BGR;
+    
+    spdlog::info("Replaying {} / {}{}", options.replayLeft, options.replayRight,
+                 fast ? " as fast as possible" : "");
+    return std::make_unique<rt::StereoCaptureSystem>(replay(options.replayLeft, left),
+                                                     replay(options.replayRight, right),
+                                                     left, right, std::move(rectifier));
+}
+
+int main(int argc, char** argv) {
     // Initialize Xenomai real-time services
     rt_print_auto_init(1);
     
     // Initialize synchronization primitives
-    rt_mutex_create(&frameMutex, "FrameMutex");
     rt_sem_create(&frameSync, "FrameSync", 0, S_PRIO);
     rt_sem_create(&preprocessSync, "PreprocessSync", 0, S_PRIO);
     rt_sem_create(&detectionSync, "DetectionSync", 0, S_PRIO);
+    rt_sem_create(&rightEyeStart, "RightEyeStart", 0, S_PRIO);
+    rt_sem_create(&rightEyeDone, "RightEyeDone", 0, S_PRIO);
+    rt_sem_create(&inferenceStart, "InferenceStart", 0, S_PRIO);
+    rt_sem_create(&rightRetrieve, "RightRetrieve", 0, S_PRIO);
     
     // Create RT tasks
-    RT_TASK t1, t2, t3, t4, t5, t6;
+    RT_TASK t1, t2, t3, t4, t5, t6, t7, t8;
     
     try {
+        const CommandLine options = parseCommandLine(argc, argv);
+        
         // Create and configure tasks
         rt_task_create(&t1, "LeftCamera", 0, 99, T_JOINABLE);
         rt_task_create(&t2, "RightCamera", 0, 99, T_JOINABLE);
@@ -282,25 +1189,71 @@ int main() {
         rt_task_create(&t4, "Detection", 0, 97, T_JOINABLE);
         rt_task_create(&t5, "Monitor", 0, 96, T_JOINABLE);
         rt_task_create(&t6, "Display", 0, 95, T_JOINABLE);
+        rt_task_create(&t7, "PreprocessRight", 0, 98, T_JOINABLE);
+        // Below the right eye helper on its core, which preempts a forward
+        // pass to letterbox the next pair
+        rt_task_create(&t8, "Inference", 0, 96, T_JOINABLE);
         
         // Set CPU affinity
         rt_task_set_affinity(&t1, CPU_MASK_CPU(2));  // Core 2
         rt_task_set_affinity(&t2, CPU_MASK_CPU(3));  // Core 3
         rt_task_set_affinity(&t3, CPU_MASK_CPU(1));  // Core 1
-        rt_task_set_affinity(&t4, CPU_MASK_CPU(3));  // Core 3
+        rt_task_set_affinity(&t4, CPU_MASK_CPU(1));  // Core 1, below preprocessing
+        rt_task_set_affinity(&t7, CPU_MASK_CPU(0));  // Core 0
+        rt_task_set_affinity(&t8, CPU_MASK_CPU(0));  // Core 0, with the right eye helper
         // t5 and t6 can run on any core
         
         // Initialize camera system and detector
-        rt::StereoCaptureSystem stereoSystem(/* config */);
+        std::shared_ptr<const rt::StereoRectifier> rectifier = createRectifier();
+        auto stereoSystem = createCaptureSystem(options, rectifier);
         rt::YOLODetector detector(/* config */);
+        detector.reserveInputs(STAGE_QUEUE_DEPTH, MAX_IMAGES);
+        const int inferenceThreads = rt::configureInferenceThreads(INFERENCE_THREADS,
+                                                                   INFERENCE_CPU_MASK);
+        spdlog::info("Inference uses {} threads on CPU mask {:#x}",
+                     inferenceThreads, INFERENCE_CPU_MASK);
+        if (!rt::inferenceMaskApplies()) {
+            spdlog::warn("OpenCV's {} backend ignores the inference CPU mask; its workers "
+                         "may run on the camera cores", cv::currentParallelFramework());
+        }
+        rt::AsyncDetector asyncDetector(detector, MAX_DETECTIONS);
+        const RegionLayout layout = options.layout;
+        if (layout == RegionLayout::Tiled && PREPROCESS_MODE == PreprocessMode::PerEye) {
+            spdlog::info("Tiled detection: up to {} tiles per eye", MAX_TILES);
+        }
+        // Frames arrive rectified, so depth matches boxes as they are
+        std::unique_ptr<rt::DepthEstimator> depth;
+        if (rectifier) {
+            rt::DepthEstimator::Config depthConfig;
+            depthConfig.rectifiedFrames = true;
+            depth = std::make_unique<rt::DepthEstimator>(rectifier, depthConfig);
+        }
+        
+        // Projecting needs the depth stage; otherwise both eyes are detected
+        const bool detectRightEye = EYE_MODE == EyeMode::Both || !depth;
+        if (!detectRightEye) {
+            spdlog::info("Detecting on the left eye, projecting boxes into the right");
+        }
+        // Warm every level at the batch this layout gives it; other counts
+        // would reshape the net inside the loop
+        detector.reserveResolutions(detectorLevels(),
+                                    detectorBatches(*stereoSystem, layout, detectRightEye));
+        PreprocessContext preprocessContext{stereoSystem.get(), &detector, layout, detectRightEye};
+        DetectionContext detectionContext{&detector, &asyncDetector, depth.get()};
+        DisplayContext displayContext{stereoSystem.get(), options.recordPath};
+        if (!displayContext.recordPath.empty()) {
+            spdlog::info("Recording the annotated stereo view to {}", displayContext.recordPath);
+        }
         
         // Start tasks
-        rt_task_start(&t1, &leftCameraTask, &stereoSystem);
-        rt_task_start(&t2, &rightCameraTask, &stereoSystem);
-        rt_task_start(&t3, &preprocessTask, nullptr);
-        rt_task_start(&t4, &detectionTask, &detector);
-        rt_task_start(&t5, &monitorTask, nullptr);
-        rt_task_start(&t6, &displayTask, nullptr);
+        rt_task_start(&t1, &leftCameraTask, stereoSystem.get());
+        rt_task_start(&t2, &rightCameraTask, stereoSystem.get());
+        rt_task_start(&t3, &preprocessTask, &preprocessContext);
+        rt_task_start(&t4, &detectionTask, &detectionContext);
+        rt_task_start(&t5, &monitorTask, stereoSystem.get());
+        rt_task_start(&t6, &displayTask, &displayContext);
+        rt_task_start(&t7, &rightEyePreprocessTask, &detector);
+        rt_task_start(&t8, &inferenceTask, &asyncDetector);
         
         // Wait for termination signal
         pause();
@@ -308,16 +1261,26 @@ int main() {
         // Cleanup
         gSignalStatus = 1;
         rt_task_join(&t1);
+        rt_sem_v(&rightRetrieve);  // A triggered right camera waits on it
         rt_task_join(&t2);
         rt_task_join(&t3);
+        rt_sem_v(&detectionSync);  // Detection may be waiting for work
         rt_task_join(&t4);
         rt_task_join(&t5);
         rt_task_join(&t6);
+        rt_sem_v(&rightEyeStart);  // Release the helper so it sees the signal
+        rt_task_join(&t7);
+        rt_sem_v(&inferenceStart);
+        rt_task_join(&t8);
+        releaseFrames();
         
-        rt_mutex_delete(&frameMutex);
         rt_sem_delete(&frameSync);
         rt_sem_delete(&preprocessSync);
         rt_sem_delete(&detectionSync);
+        rt_sem_delete(&rightEyeStart);
+        rt_sem_delete(&rightEyeDone);
+        rt_sem_delete(&inferenceStart);
+        rt_sem_delete(&rightRetrieve);
         
     } catch (const std::exception& e) {
         spdlog::error("Fatal error: {}", e.what());
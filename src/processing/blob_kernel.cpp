@@ -0,0 +1,462 @@
+#include "blob_kernel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if RT_HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace rt {
+
+namespace {
+
+constexpr int kChannels = 3;
+constexpr float kNormalize = 1.0f / 255.0f;
+
+// Source taps and weight for one output coordinate, same centre alignment
+// as cv::resize with INTER_LINEAR
+void bilinearTap(int dst, float ratio, int sourceSize, int& index0, int& index1, float& weight) {
+    const float position = (dst + 0.5f) * ratio - 0.5f;
+    int index = static_cast<int>(std::floor(position));
+    float frac = position - index;
+    if (index < 0) {
+        index = 0;
+        frac = 0.0f;
+    }
+    if (index >= sourceSize - 1) {
+        index = sourceSize - 1;
+        frac = 0.0f;
+    }
+    index0 = index;
+    index1 = std::min(index + 1, sourceSize - 1);
+    weight = frac;
+}
+
+void horizontalScalar(const uint8_t* row, const int32_t* offset0, const int32_t* offset1,
+                      const float* weight, int count, int /*vectorCount*/, float* planes) {
+    float* r = planes;
+    float* g = planes + count;
+    float* b = planes + 2 * count;
+    for (int i = 0; i < count; ++i) {
+        const uint8_t* p0 = row + offset0[i];
+        const uint8_t* p1 = row + offset1[i];
+        const float w = weight[i];
+        b[i] = p0[0] + (p1[0] - p0[0]) * w;
+        g[i] = p0[1] + (p1[1] - p0[1]) * w;
+        r[i] = p0[2] + (p1[2] - p0[2]) * w;
+    }
+}
+
+inline float clampByte(float value) {
+    return std::min(std::max(value, 0.0f), 255.0f);
+}
+
+// BT.601 video range, the conversion cv::COLOR_YUV2BGR_YUY2 applies
+inline void yuyvPixel(const uint8_t* row, int32_t offset, float& b, float& g, float& r) {
+    const uint8_t* pair = row + (offset & ~3);  // Y0 U Y1 V
+    const float y = 1.164f * std::max(row[offset] - 16, 0);
+    const float u = pair[1] - 128.0f;
+    const float v = pair[3] - 128.0f;
+    b = clampByte(y + 2.018f * u);
+    g = clampByte(y - 0.391f * u - 0.813f * v);
+    r = clampByte(y + 1.596f * v);
+}
+
+inline void yuyvColumn(const uint8_t* row, int32_t offset0, int32_t offset1, float weight,
+                       float& b, float& g, float& r) {
+    float b0, g0, r0, b1, g1, r1;
+    yuyvPixel(row, offset0, b0, g0, r0);
+    yuyvPixel(row, offset1, b1, g1, r1);
+    b = b0 + (b1 - b0) * weight;
+    g = g0 + (g1 - g0) * weight;
+    r = r0 + (r1 - r0) * weight;
+}
+
+// Packed 4:2:2 rows: only the two taps of each output column are
+// converted, so a downscaled input never converts the full frame
+void horizontalYuyv(const uint8_t* row, const int32_t* offset0, const int32_t* offset1,
+                    const float* weight, int count, int /*vectorCount*/, float* planes) {
+    float* r = planes;
+    float* g = planes + count;
+    float* b = planes + 2 * count;
+    for (int i = 0; i < count; ++i) {
+        yuyvColumn(row, offset0[i], offset1[i], weight[i], b[i], g[i], r[i]);
+    }
+}
+
+void verticalScalar(const float* top, const float* bottom, float weight, int count, float* dst) {
+    for (int i = 0; i < count; ++i) {
+        dst[i] = (top[i] + (bottom[i] - top[i]) * weight) * kNormalize;
+    }
+}
+
+#if RT_HAVE_X86_SIMD
+
+// The Y0 U Y1 V word holding the pixel at offset
+inline int32_t yuyvPair(const uint8_t* row, int32_t offset) {
+    int32_t pair;
+    std::memcpy(&pair, row + (offset & ~3), sizeof(pair));
+    return pair;
+}
+
+// Four pixels from their pair words; second marks the lanes whose pixel
+// is the pair's Y1
+inline void yuyvToBgrSSE2(__m128i pairs, __m128i second, __m128& b, __m128& g, __m128& r) {
+    const __m128i byteMask = _mm_set1_epi32(0xff);
+    const __m128i luma = _mm_or_si128(_mm_and_si128(second, _mm_srli_epi32(pairs, 16)),
+                                      _mm_andnot_si128(second, pairs));
+    const __m128 y = _mm_mul_ps(_mm_set1_ps(1.164f),
+        _mm_max_ps(_mm_sub_ps(_mm_cvtepi32_ps(_mm_and_si128(luma, byteMask)),
+                              _mm_set1_ps(16.0f)), _mm_setzero_ps()));
+    const __m128 u = _mm_sub_ps(
+        _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(pairs, 8), byteMask)), _mm_set1_ps(128.0f));
+    const __m128 v = _mm_sub_ps(_mm_cvtepi32_ps(_mm_srli_epi32(pairs, 24)), _mm_set1_ps(128.0f));
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 full = _mm_set1_ps(255.0f);
+    b = _mm_min_ps(_mm_max_ps(_mm_add_ps(y, _mm_mul_ps(_mm_set1_ps(2.018f), u)), zero), full);
+    g = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_sub_ps(y, _mm_mul_ps(_mm_set1_ps(0.391f), u)),
+                                         _mm_mul_ps(_mm_set1_ps(0.813f), v)), zero), full);
+    r = _mm_min_ps(_mm_max_ps(_mm_add_ps(y, _mm_mul_ps(_mm_set1_ps(1.596f), v)), zero), full);
+}
+
+// SSE2 has no gather, so the pair words are loaded one by one and only the
+// conversion and blend run four columns wide
+void horizontalYuyvSSE2(const uint8_t* row, const int32_t* offset0, const int32_t* offset1,
+                        const float* weight, int count, int vectorCount, float* planes) {
+    float* r = planes;
+    float* g = planes + count;
+    float* b = planes + 2 * count;
+    const __m128i two = _mm_set1_epi32(2);
+
+    int i = 0;
+    for (; i + 4 <= vectorCount; i += 4) {
+        const __m128i idx0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(offset0 + i));
+        const __m128i idx1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(offset1 + i));
+        const __m128i p0 = _mm_set_epi32(yuyvPair(row, offset0[i + 3]), yuyvPair(row, offset0[i + 2]),
+                                         yuyvPair(row, offset0[i + 1]), yuyvPair(row, offset0[i]));
+        const __m128i p1 = _mm_set_epi32(yuyvPair(row, offset1[i + 3]), yuyvPair(row, offset1[i + 2]),
+                                         yuyvPair(row, offset1[i + 1]), yuyvPair(row, offset1[i]));
+        __m128 b0, g0, r0, b1, g1, r1;
+        yuyvToBgrSSE2(p0, _mm_cmpeq_epi32(_mm_and_si128(idx0, two), two), b0, g0, r0);
+        yuyvToBgrSSE2(p1, _mm_cmpeq_epi32(_mm_and_si128(idx1, two), two), b1, g1, r1);
+
+        const __m128 w = _mm_loadu_ps(weight + i);
+        _mm_storeu_ps(b + i, _mm_add_ps(b0, _mm_mul_ps(_mm_sub_ps(b1, b0), w)));
+        _mm_storeu_ps(g + i, _mm_add_ps(g0, _mm_mul_ps(_mm_sub_ps(g1, g0), w)));
+        _mm_storeu_ps(r + i, _mm_add_ps(r0, _mm_mul_ps(_mm_sub_ps(r1, r0), w)));
+    }
+
+    for (; i < count; ++i) {
+        yuyvColumn(row, offset0[i], offset1[i], weight[i], b[i], g[i], r[i]);
+    }
+}
+
+void verticalSSE2(const float* top, const float* bottom, float weight, int count, float* dst) {
+    const __m128 w = _mm_set1_ps(weight);
+    const __m128 k = _mm_set1_ps(kNormalize);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 t = _mm_loadu_ps(top + i);
+        const __m128 b = _mm_loadu_ps(bottom + i);
+        const __m128 v = _mm_add_ps(t, _mm_mul_ps(_mm_sub_ps(b, t), w));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(v, k));
+    }
+    verticalScalar(top + i, bottom + i, weight, count - i, dst + i);
+}
+
+RT_TARGET_AVX2
+inline __m256 unpackChannel(__m256i pixels, int shift) {
+    const __m256i byteMask = _mm256_set1_epi32(0xff);
+    return _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(pixels, shift), byteMask));
+}
+
+// Each tap is one unaligned 32-bit gather of B, G, R plus the next byte,
+// which is why only columns up to vectorCount may take this path
+RT_TARGET_AVX2
+void horizontalAVX2(const uint8_t* row, const int32_t* offset0, const int32_t* offset1,
+                    const float* weight, int count, int vectorCount, float* planes) {
+    float* r = planes;
+    float* g = planes + count;
+    float* b = planes + 2 * count;
+    const int* base = reinterpret_cast<const int*>(row);
+
+    int i = 0;
+    for (; i + 8 <= vectorCount; i += 8) {
+        const __m256i idx0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offset0 + i));
+        const __m256i idx1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offset1 + i));
+        const __m256i p0 = _mm256_i32gather_epi32(base, idx0, 1);
+        const __m256i p1 = _mm256_i32gather_epi32(base, idx1, 1);
+        const __m256 w = _mm256_loadu_ps(weight + i);
+
+        const __m256 b0 = unpackChannel(p0, 0), b1 = unpackChannel(p1, 0);
+        const __m256 g0 = unpackChannel(p0, 8), g1 = unpackChannel(p1, 8);
+        const __m256 r0 = unpackChannel(p0, 16), r1 = unpackChannel(p1, 16);
+        _mm256_storeu_ps(b + i, _mm256_fmadd_ps(_mm256_sub_ps(b1, b0), w, b0));
+        _mm256_storeu_ps(g + i, _mm256_fmadd_ps(_mm256_sub_ps(g1, g0), w, g0));
+        _mm256_storeu_ps(r + i, _mm256_fmadd_ps(_mm256_sub_ps(r1, r0), w, r0));
+    }
+
+    for (; i < count; ++i) {
+        const uint8_t* q0 = row + offset0[i];
+        const uint8_t* q1 = row + offset1[i];
+        const float wi = weight[i];
+        b[i] = q0[0] + (q1[0] - q0[0]) * wi;
+        g[i] = q0[1] + (q1[1] - q0[1]) * wi;
+        r[i] = q0[2] + (q1[2] - q0[2]) * wi;
+    }
+}
+
+// Eight pixels gathered as their pair words; the luma byte is picked by
+// bit 1 of each pixel's offset
+RT_TARGET_AVX2
+inline void yuyvToBgrAVX2(__m256i pairs, __m256i offsets, __m256& b, __m256& g, __m256& r) {
+    const __m256i lumaShift = _mm256_slli_epi32(
+        _mm256_and_si256(offsets, _mm256_set1_epi32(2)), 3);
+    const __m256i luma = _mm256_and_si256(_mm256_srlv_epi32(pairs, lumaShift),
+                                          _mm256_set1_epi32(0xff));
+    const __m256 y = _mm256_mul_ps(_mm256_set1_ps(1.164f),
+        _mm256_max_ps(_mm256_sub_ps(_mm256_cvtepi32_ps(luma), _mm256_set1_ps(16.0f)),
+                      _mm256_setzero_ps()));
+    const __m256 u = _mm256_sub_ps(unpackChannel(pairs, 8), _mm256_set1_ps(128.0f));
+    const __m256 v = _mm256_sub_ps(unpackChannel(pairs, 24), _mm256_set1_ps(128.0f));
+
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 full = _mm256_set1_ps(255.0f);
+    b = _mm256_min_ps(_mm256_max_ps(
+        _mm256_fmadd_ps(_mm256_set1_ps(2.018f), u, y), zero), full);
+    g = _mm256_min_ps(_mm256_max_ps(_mm256_fnmadd_ps(_mm256_set1_ps(0.813f), v,
+        _mm256_fnmadd_ps(_mm256_set1_ps(0.391f), u, y)), zero), full);
+    r = _mm256_min_ps(_mm256_max_ps(
+        _mm256_fmadd_ps(_mm256_set1_ps(1.596f), v, y), zero), full);
+}
+
+// Each tap is one 32-bit gather of its whole pixel pair, which stays
+// inside the row, so every column may take this path
+RT_TARGET_AVX2
+void horizontalYuyvAVX2(const uint8_t* row, const int32_t* offset0, const int32_t* offset1,
+                        const float* weight, int count, int vectorCount, float* planes) {
+    float* r = planes;
+    float* g = planes + count;
+    float* b = planes + 2 * count;
+    const int* base = reinterpret_cast<const int*>(row);
+    const __m256i pairMask = _mm256_set1_epi32(~3);
+
+    int i = 0;
+    for (; i + 8 <= vectorCount; i += 8) {
+        const __m256i idx0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offset0 + i));
+        const __m256i idx1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offset1 + i));
+        const __m256i p0 = _mm256_i32gather_epi32(base, _mm256_and_si256(idx0, pairMask), 1);
+        const __m256i p1 = _mm256_i32gather_epi32(base, _mm256_and_si256(idx1, pairMask), 1);
+        __m256 b0, g0, r0, b1, g1, r1;
+        yuyvToBgrAVX2(p0, idx0, b0, g0, r0);
+        yuyvToBgrAVX2(p1, idx1, b1, g1, r1);
+
+        const __m256 w = _mm256_loadu_ps(weight + i);
+        _mm256_storeu_ps(b + i, _mm256_fmadd_ps(_mm256_sub_ps(b1, b0), w, b0));
+        _mm256_storeu_ps(g + i, _mm256_fmadd_ps(_mm256_sub_ps(g1, g0), w, g0));
+        _mm256_storeu_ps(r + i, _mm256_fmadd_ps(_mm256_sub_ps(r1, r0), w, r0));
+    }
+
+    for (; i < count; ++i) {
+        yuyvColumn(row, offset0[i], offset1[i], weight[i], b[i], g[i], r[i]);
+    }
+}
+
+RT_TARGET_AVX2
+void verticalAVX2(const float* top, const float* bottom, float weight, int count, float* dst) {
+    const __m256 w = _mm256_set1_ps(weight);
+    const __m256 k = _mm256_set1_ps(kNormalize);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 t = _mm256_loadu_ps(top + i);
+        const __m256 b = _mm256_loadu_ps(bottom + i);
+        const __m256 v = _mm256_fmadd_ps(_mm256_sub_ps(b, t), w, t);
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(v, k));
+    }
+    verticalScalar(top + i, bottom + i, weight, count - i, dst + i);
+}
+
+#endif
+
+} // namespace
+
+BlobKernel::BlobKernel(const cv::Size& inputSize, SimdLevel level)
+    : inputSize_(inputSize)
+    , level_(std::min(level, detectSimdLevel()))
+    , horizontal_(&horizontalScalar)
+    , horizontalYuyv_(&horizontalYuyv)
+    , vertical_(&verticalScalar) {
+
+    if (inputSize.width <= 0 || inputSize.height <= 0) {
+        throw std::invalid_argument("Blob kernel needs a positive input size");
+    }
+
+#if RT_HAVE_X86_SIMD
+    if (level_ == SimdLevel::AVX2) {
+        horizontal_ = &horizontalAVX2;
+        horizontalYuyv_ = &horizontalYuyvAVX2;
+        vertical_ = &verticalAVX2;
+    } else if (level_ == SimdLevel::SSE2) {
+        horizontalYuyv_ = &horizontalYuyvSSE2;
+        vertical_ = &verticalSSE2;
+    }
+#endif
+
+    // Sized for the largest content area so prepare() never reallocates
+    xOffset0_.reserve(inputSize.width);
+    xOffset1_.reserve(inputSize.width);
+    xWeight_.reserve(inputSize.width);
+    yIndex0_.reserve(inputSize.height);
+    yIndex1_.reserve(inputSize.height);
+    yWeight_.reserve(inputSize.height);
+    for (auto& row : rows_) {
+        row.resize(static_cast<size_t>(kChannels) * inputSize.width);
+    }
+}
+
+std::array<int, 4> BlobKernel::blobShape() const {
+    return {1, kChannels, inputSize_.height, inputSize_.width};
+}
+
+LetterboxTransform BlobKernel::letterbox(const cv::Mat& frame, float* dst) {
+    return letterbox(frame, dst, cv::Rect(cv::Point(), inputSize_));
+}
+
+LetterboxTransform BlobKernel::letterbox(const cv::Mat& frame, float* dst,
+                                         const cv::Rect& cell) {
+    if (frame.empty()) {
+        throw std::invalid_argument("Blob kernel needs a non-empty frame");
+    }
+    if (cell.area() <= 0 || (cell & cv::Rect(cv::Point(), inputSize_)) != cell) {
+        throw std::invalid_argument("Blob kernel cell must lie within the input");
+    }
+
+    LetterboxTransform transform = LetterboxTransform::compute(frame.size(), cell.size());
+    transform.padX += cell.x;
+    transform.padY += cell.y;
+    const cv::Rect content = transform.contentRect() & cell;
+
+    // Only the borders are painted; the content is overwritten below
+    const cv::Point end = content.br();
+    pad(dst, cv::Rect(cell.x, cell.y, cell.width, content.y - cell.y));
+    pad(dst, cv::Rect(cell.x, end.y, cell.width, cell.br().y - end.y));
+    pad(dst, cv::Rect(cell.x, content.y, content.x - cell.x, content.height));
+    pad(dst, cv::Rect(end.x, content.y, cell.br().x - end.x, content.height));
+
+    resize(frame, dst, content);
+    return transform;
+}
+
+void BlobKernel::pad(float* dst, const cv::Rect& area) const {
+    if (area.width <= 0 || area.height <= 0) {
+        return;
+    }
+    const float value = static_cast<float>(kLetterboxPad[0]) * kNormalize;
+    const size_t planeSize = static_cast<size_t>(inputSize_.area());
+    for (int c = 0; c < kChannels; ++c) {
+        for (int y = area.y; y < area.y + area.height; ++y) {
+            float* row = dst + c * planeSize + static_cast<size_t>(y) * inputSize_.width;
+            std::fill(row + area.x, row + area.x + area.width, value);
+        }
+    }
+}
+
+void BlobKernel::resize(const cv::Mat& frame, float* dst, const cv::Rect& area) {
+    if (frame.empty() || (frame.type() != CV_8UC3 && frame.type() != CV_8UC2)) {
+        throw std::invalid_argument("Blob kernel needs a BGR8 or YUYV frame");
+    }
+    if (area.area() <= 0 || (area & cv::Rect(cv::Point(), inputSize_)) != area) {
+        throw std::invalid_argument("Blob kernel area must lie within the input");
+    }
+
+    // A crop starting at an odd YUYV column begins mid pixel pair
+    int pairPhase = 0;
+    if (frame.type() == CV_8UC2) {
+        cv::Size whole;
+        cv::Point origin;
+        frame.locateROI(whole, origin);
+        pairPhase = origin.x & 1;
+    }
+
+    prepare(frame.size(), area.size(), frame.type(), pairPhase);
+    cachedRow_ = {{-1, -1}};  // strips belong to the previous frame
+
+    const size_t planeSize = static_cast<size_t>(inputSize_.area());
+    const int count = area.width;
+    for (int y = 0; y < area.height; ++y) {
+        const float* top = sampleRow(frame, yIndex0_[y], -1);
+        const float* bottom = sampleRow(frame, yIndex1_[y], yIndex0_[y]);
+
+        float* out = dst + (area.y + y) * inputSize_.width + area.x;
+        for (int c = 0; c < kChannels; ++c) {
+            vertical_(top + c * count, bottom + c * count, yWeight_[y], count,
+                      out + c * planeSize);
+        }
+    }
+}
+
+void BlobKernel::prepare(const cv::Size& source, const cv::Size& content, int type,
+                         int pairPhase) {
+    if (source == sourceSize_ && content == contentSize_ && type == sourceType_ &&
+        pairPhase == pairPhase_) {
+        return;
+    }
+    sourceSize_ = source;
+    contentSize_ = content;
+    sourceType_ = type;
+    pairPhase_ = pairPhase;
+
+    // YUYV offsets count from the start of the row's first whole pixel pair
+    const bool yuyv = type == CV_8UC2;
+    const int pixelBytes = yuyv ? 2 : kChannels;
+    sampler_ = yuyv ? horizontalYuyv_ : horizontal_;
+    rowShift_ = pairPhase * pixelBytes;
+
+    const float ratioX = static_cast<float>(source.width) / content.width;
+    xOffset0_.resize(content.width);
+    xOffset1_.resize(content.width);
+    xWeight_.resize(content.width);
+    for (int x = 0; x < content.width; ++x) {
+        int x0, x1;
+        bilinearTap(x, ratioX, source.width, x0, x1, xWeight_[x]);
+        xOffset0_[x] = x0 * pixelBytes + rowShift_;
+        xOffset1_[x] = x1 * pixelBytes + rowShift_;
+    }
+
+    // A 4-byte BGR gather at the last pixel of a row would read one byte
+    // past it; taps are monotonic, so the safe columns form a prefix. YUYV
+    // taps read their whole pixel pair, which the scalar path reads too.
+    const int32_t lastSafe = source.width * kChannels - 4;
+    vectorCount_ = yuyv ? content.width : 0;
+    while (!yuyv && vectorCount_ < content.width && xOffset1_[vectorCount_] <= lastSafe) {
+        ++vectorCount_;
+    }
+
+    const float ratioY = static_cast<float>(source.height) / content.height;
+    yIndex0_.resize(content.height);
+    yIndex1_.resize(content.height);
+    yWeight_.resize(content.height);
+    for (int y = 0; y < content.height; ++y) {
+        bilinearTap(y, ratioY, source.height, yIndex0_[y], yIndex1_[y], yWeight_[y]);
+    }
+}
+
+const float* BlobKernel::sampleRow(const cv::Mat& frame, int y, int keep) {
+    for (size_t i = 0; i < rows_.size(); ++i) {
+        if (cachedRow_[i] == y) {
+            return rows_[i].data();
+        }
+    }
+
+    // Evict whichever strip the current output row does not still need
+    const size_t victim = cachedRow_[0] == keep ? 1 : 0;
+    sampler_(frame.ptr<uint8_t>(y) - rowShift_, xOffset0_.data(), xOffset1_.data(),
+             xWeight_.data(), contentSize_.width, vectorCount_, rows_[victim].data());
+    cachedRow_[victim] = y;
+    return rows_[victim].data();
+}
+
+} // namespace rt
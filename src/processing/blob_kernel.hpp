@@ -0,0 +1,87 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "letterbox.hpp"
+#include "../utils/cpu_features.hpp"
+
+namespace rt {
+
+// Turns a BGR8 camera frame into a planar float network input in a single
+// pass: bilinear resize, BGR->RGB and scaling to [0, 1] are fused, and the
+// R, G and B planes (inputSize.area() floats each, NCHW order) are written
+// straight into caller memory, e.g. a detector's input tensor.
+//
+// Each source row is sampled horizontally once into a small cached strip
+// and blended vertically into the planes; sampling tables are rebuilt only
+// when the source geometry changes, so steady-state calls do not allocate.
+// The inner loops have AVX2 and SSE2 variants picked at runtime; for BGR
+// the SSE2 level vectorizes the vertical pass only.
+//
+// Packed YUYV frames (CV_8UC2, as captured without conversion) are
+// accepted too: the horizontal pass converts only the pixels it samples,
+// so colour conversion costs scale with the input size, not the frame's.
+class BlobKernel {
+public:
+    explicit BlobKernel(const cv::Size& inputSize, SimdLevel level = detectSimdLevel());
+
+    // Letterboxes the whole frame into dst (3 * inputSize.area() floats),
+    // painting the borders with kLetterboxPad
+    LetterboxTransform letterbox(const cv::Mat& frame, float* dst);
+
+    // Letterboxes the frame into cell of dst only, e.g. one crop of a
+    // mosaic; the transform maps network pixels, cell offset included
+    LetterboxTransform letterbox(const cv::Mat& frame, float* dst, const cv::Rect& cell);
+
+    // Paints area of dst with kLetterboxPad
+    void pad(float* dst, const cv::Rect& area) const;
+
+    // Stretches the whole frame into area of dst; pixels outside area are
+    // left untouched
+    void resize(const cv::Mat& frame, float* dst, const cv::Rect& area);
+
+    const cv::Size& inputSize() const { return inputSize_; }
+    SimdLevel simdLevel() const { return level_; }
+
+    // Shape of a single-image tensor for this kernel: {1, 3, height, width}
+    std::array<int, 4> blobShape() const;
+
+    using HorizontalFn = void (*)(const uint8_t* row, const int32_t* offset0,
+                                  const int32_t* offset1, const float* weight,
+                                  int count, int vectorCount, float* planes);
+    using VerticalFn = void (*)(const float* top, const float* bottom, float weight,
+                                int count, float* dst);
+
+private:
+    void prepare(const cv::Size& source, const cv::Size& content, int type, int pairPhase);
+    const float* sampleRow(const cv::Mat& frame, int y, int keep);
+
+    cv::Size inputSize_;
+    SimdLevel level_;
+    HorizontalFn horizontal_;
+    HorizontalFn horizontalYuyv_;
+    VerticalFn vertical_;
+
+    // Sampling tables for the current source -> content geometry
+    cv::Size sourceSize_;
+    cv::Size contentSize_;
+    int sourceType_{-1};
+    int pairPhase_{0};   // 1 when a YUYV row starts on the second pixel of a pair
+    int rowShift_{0};    // bytes back from a row's first pixel to its pair
+    HorizontalFn sampler_{nullptr};
+    std::vector<int32_t> xOffset0_;  // byte offsets of the left/right taps
+    std::vector<int32_t> xOffset1_;
+    std::vector<float> xWeight_;
+    std::vector<int> yIndex0_;
+    std::vector<int> yIndex1_;
+    std::vector<float> yWeight_;
+    int vectorCount_{0};  // leading columns safe for 4-byte gathers
+
+    // Horizontally sampled source rows, planar R|G|B, values in [0, 255]
+    std::array<std::vector<float>, 2> rows_;
+    std::array<int, 2> cachedRow_{{-1, -1}};
+};
+
+} // namespace rt
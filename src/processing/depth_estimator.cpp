@@ -0,0 +1,230 @@
+#include "depth_estimator.hpp"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+namespace rt {
+
+namespace {
+
+// Header over the top-left corner of a preallocated buffer; writing a
+// result of exactly this size into it keeps the buffer
+cv::Mat corner(cv::Mat& storage, const cv::Size& size) {
+    return storage(cv::Rect(cv::Point(), size));
+}
+
+} // namespace
+
+DepthEstimator::DepthEstimator(std::shared_ptr<const StereoRectifier> rectifier,
+                               const Config& config)
+    : rectifier_(std::move(rectifier))
+    , config_(config) {
+    if (!rectifier_) {
+        throw std::invalid_argument("Depth estimator needs a rectifier");
+    }
+    if (config.numDisparities <= 0 || config.numDisparities % 16 != 0 ||
+        config.blockSize < 5 || config.blockSize % 2 == 0 || config.padding < 0.0f ||
+        config.coreFraction <= 0.0f || config.coreFraction > 1.0f ||
+        config.minValidFraction < 0.0f || config.minValidFraction > 1.0f) {
+        throw std::invalid_argument("Invalid depth estimator configuration");
+    }
+
+    matcher_ = cv::StereoBM::create(config.numDisparities, config.blockSize);
+    const cv::Size& size = rectifier_->outputSize();
+    for (int eye = 0; eye < 2; ++eye) {
+        grayStorage_[eye].create(size, CV_8UC1);
+        mirroredStorage_[eye].create(size, CV_8UC1);
+    }
+    disparityStorage_.create(size, CV_16SC1);
+    scoresStorage_.create(1, config.numDisparities + 1, CV_32FC1);
+    samples_.reserve(static_cast<size_t>(size.area()));
+}
+
+DepthEstimator::DepthEstimator(const StereoCalibration& calibration, const Config& config)
+    : DepthEstimator(std::make_shared<StereoRectifier>(calibration, calibration.imageSize()),
+                     config) {
+}
+
+void DepthEstimator::estimate(const cv::Mat& left, const cv::Mat& right, Eye eye,
+                              std::vector<YOLODetector::DetectionResult>& detections) {
+    checkFrames(left, right);
+    for (auto& detection : detections) {
+        detection.distance = boxDistance(left, right, eye, detection.box);
+    }
+}
+
+void DepthEstimator::project(const cv::Mat& left, const cv::Mat& right,
+                             std::vector<YOLODetector::DetectionResult>& leftDetections,
+                             std::vector<YOLODetector::DetectionResult>& rightDetections) {
+    checkFrames(left, right);
+    const cv::Rect frame(cv::Point(), rectifier_->outputSize());
+    rightDetections.clear();
+    for (auto& detection : leftDetections) {
+        const cv::Rect target = rectifiedBox(Eye::Left, detection.box);
+        float disparity = 0.0f;
+        const bool matched = !target.empty() && matchBox(left, right, target, disparity);
+        detection.distance = matched ? static_cast<float>(rectifier_->distance(disparity)) : 0.0f;
+
+        // Rectified rows are shared, so the box only moves along x
+        const cv::Rect shifted = target - cv::Point(matched ? cvRound(disparity) : 0, 0);
+        rightDetections.push_back(detection);
+        rightDetections.back().box = config_.rectifiedFrames
+            ? shifted & frame
+            : rectifier_->unrectifyBox(Eye::Right, shifted);
+    }
+}
+
+void DepthEstimator::checkFrames(const cv::Mat& left, const cv::Mat& right) const {
+    const cv::Size& expected = config_.rectifiedFrames ? rectifier_->outputSize()
+                                                       : rectifier_->inputSize();
+    if (left.size() != expected || right.size() != expected) {
+        throw std::invalid_argument("Stereo frames do not match the rectifier's size");
+    }
+}
+
+cv::Rect DepthEstimator::rectifiedBox(Eye eye, const cv::Rect& box) const {
+    return config_.rectifiedFrames ? box & cv::Rect(cv::Point(), rectifier_->outputSize())
+                                   : rectifier_->rectifyBox(eye, box);
+}
+
+float DepthEstimator::boxDistance(const cv::Mat& left, const cv::Mat& right, Eye eye,
+                                  const cv::Rect& box) {
+    const cv::Rect frame(cv::Point(), rectifier_->outputSize());
+    const cv::Rect target = rectifiedBox(eye, box);
+    if (target.empty()) {
+        return 0.0f;
+    }
+
+    // The partner eye sees the object up to numDisparities pixels to the
+    // left (right eye) or right (left eye) in rectified rows
+    const int padX = static_cast<int>(config_.padding * target.width);
+    const int padY = static_cast<int>(config_.padding * target.height);
+    const int range = config_.numDisparities;
+    const cv::Rect padded(target.x - padX, target.y - padY,
+                          target.width + 2 * padX, target.height + 2 * padY);
+    const cv::Rect strip = cv::Rect(eye == Eye::Left ? padded.x - range : padded.x, padded.y,
+                                    padded.width + range, padded.height) & frame;
+    if (strip.width < range + config_.blockSize || strip.height < config_.blockSize) {
+        return 0.0f;
+    }
+
+    gray_[0] = corner(grayStorage_[0], strip.size());
+    gray_[1] = corner(grayStorage_[1], strip.size());
+    disparity_ = corner(disparityStorage_, strip.size());
+    rectifyStrip(left, Eye::Left, strip, gray_[0]);
+    rectifyStrip(right, Eye::Right, strip, gray_[1]);
+    if (eye == Eye::Left) {
+        matcher_->compute(gray_[0], gray_[1], disparity_);
+    } else {
+        // Mirrored, the right eye becomes the reference BM expects
+        mirrored_[0] = corner(mirroredStorage_[0], strip.size());
+        mirrored_[1] = corner(mirroredStorage_[1], strip.size());
+        cv::flip(gray_[1], mirrored_[0], 1);
+        cv::flip(gray_[0], mirrored_[1], 1);
+        matcher_->compute(mirrored_[0], mirrored_[1], disparity_);
+    }
+
+    const int coreWidth = std::max(1, static_cast<int>(config_.coreFraction * target.width));
+    const int coreHeight = std::max(1, static_cast<int>(config_.coreFraction * target.height));
+    cv::Rect core(target.x + (target.width - coreWidth) / 2 - strip.x,
+                  target.y + (target.height - coreHeight) / 2 - strip.y, coreWidth, coreHeight);
+    if (eye == Eye::Right) {
+        core.x = strip.width - core.x - core.width;
+    }
+    core &= cv::Rect(0, 0, strip.width, strip.height);
+    if (core.empty()) {
+        return 0.0f;
+    }
+
+    // Disparities are fixed point with 4 fractional bits; unmatched pixels
+    // are negative
+    samples_.clear();
+    for (int y = core.y; y < core.y + core.height; ++y) {
+        const int16_t* row = disparity_.ptr<int16_t>(y);
+        for (int x = core.x; x < core.x + core.width; ++x) {
+            if (row[x] > 0) {
+                samples_.push_back(row[x]);
+            }
+        }
+    }
+    if (samples_.empty() ||
+        samples_.size() < config_.minValidFraction * static_cast<float>(core.area())) {
+        return 0.0f;
+    }
+
+    auto median = samples_.begin() + samples_.size() / 2;
+    std::nth_element(samples_.begin(), median, samples_.end());
+    return static_cast<float>(rectifier_->distance(*median / 16.0));
+}
+
+bool DepthEstimator::matchBox(const cv::Mat& left, const cv::Mat& right, const cv::Rect& target,
+                              float& disparity) {
+    // The centre of the box, searched for over the disparity range to its
+    // left in the right eye
+    const int coreWidth = std::max(1, static_cast<int>(config_.coreFraction * target.width));
+    const int coreHeight = std::max(1, static_cast<int>(config_.coreFraction * target.height));
+    const cv::Rect core(target.x + (target.width - coreWidth) / 2,
+                        target.y + (target.height - coreHeight) / 2, coreWidth, coreHeight);
+    const cv::Rect search = cv::Rect(core.x - config_.numDisparities, core.y,
+                                     core.width + config_.numDisparities, core.height) &
+                            cv::Rect(cv::Point(), rectifier_->outputSize());
+    if (core.width < 4 || core.height < 4 || search.width <= core.width) {
+        return false;
+    }
+
+    gray_[0] = corner(grayStorage_[0], core.size());
+    gray_[1] = corner(grayStorage_[1], search.size());
+    rectifyStrip(left, Eye::Left, core, gray_[0]);
+    rectifyStrip(right, Eye::Right, search, gray_[1]);
+
+    // A flat patch matches anywhere
+    cv::Scalar mean, deviation;
+    cv::meanStdDev(gray_[0], mean, deviation);
+    if (deviation[0] < config_.minTexture) {
+        return false;
+    }
+
+    scores_ = corner(scoresStorage_, cv::Size(search.width - core.width + 1, 1));
+    cv::matchTemplate(gray_[1], gray_[0], scores_, cv::TM_SQDIFF_NORMED);
+    double cost = 0.0;
+    cv::Point best;
+    cv::minMaxLoc(scores_, &cost, nullptr, &best, nullptr);
+    if (cost > config_.maxMatchCost) {
+        return false;
+    }
+
+    // Sub-pixel position from a parabola through the neighbouring costs
+    float offset = 0.0f;
+    if (best.x > 0 && best.x + 1 < scores_.cols) {
+        const float before = scores_.at<float>(0, best.x - 1);
+        const float at = scores_.at<float>(0, best.x);
+        const float after = scores_.at<float>(0, best.x + 1);
+        const float curvature = before - 2.0f * at + after;
+        if (curvature > 0.0f) {
+            offset = 0.5f * (before - after) / curvature;
+        }
+    }
+    disparity = static_cast<float>(core.x - search.x) - (static_cast<float>(best.x) + offset);
+    return disparity > 0.0f;
+}
+
+void DepthEstimator::rectifyStrip(const cv::Mat& frame, Eye eye, const cv::Rect& strip,
+                                  cv::Mat& gray) {
+    if (config_.rectifiedFrames) {
+        rectified_ = frame(strip);  // a view, no copy
+    } else {
+        if (scratchStorage_.empty() || scratchStorage_.type() != frame.type()) {
+            scratchStorage_.create(rectifier_->outputSize(), frame.type());
+        }
+        scratch_ = corner(scratchStorage_, strip.size());
+        rectifier_->rectify(eye, frame, strip, scratch_);
+        rectified_ = scratch_;
+    }
+    if (rectified_.channels() == 1) {
+        rectified_.copyTo(gray);
+    } else {
+        cv::cvtColor(rectified_, gray, cv::COLOR_BGR2GRAY);
+    }
+}
+
+} // namespace rt
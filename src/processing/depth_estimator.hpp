@@ -0,0 +1,103 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/calib3d.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../camera/stereo_calibration.hpp"
+#include "../camera/stereo_rectifier.hpp"
+#include "../detection/yolo_detector.hpp"
+
+namespace rt {
+
+// Estimates the distance of detected objects from a calibrated stereo
+// pair, running block matching only around the detection boxes.
+//
+// For each box, the strip of rows it spans is rectified in both eyes,
+// wide enough to cover the box (padded by padding on every side) plus the
+// disparity search range, and matched with cv::StereoBM. The distance is
+// the median disparity over the central coreFraction of the box, which
+// keeps background at the box edges out of it. Boxes where fewer than
+// minValidFraction of those pixels match get distance 0 (unknown).
+//
+// Boxes from either eye work: right-eye boxes are matched on mirrored
+// strips, which turns them into left-referenced ones.
+//
+// project() is the detect-once alternative for detections of the left eye
+// only: each box's centre patch is searched for along its rectified rows
+// in the right eye (one template match over the disparity range rather
+// than a dense disparity map), which gives both the right-eye box and the
+// distance.
+//
+// Strips are rectified with the rig's shared StereoRectifier tables. When
+// capture already rectified the frames with them (rectifiedFrames), boxes
+// and strips are taken as they are.
+class DepthEstimator {
+public:
+    using Eye = StereoEye;
+
+    struct Config {
+        int numDisparities{64};     // search range in pixels, multiple of 16
+        int blockSize{11};          // odd
+        float padding{0.1f};        // of the box size
+        float coreFraction{0.5f};   // of the box width and height
+        float minValidFraction{0.2f};
+        float maxMatchCost{0.25f};  // normalized SSD of an accepted projection
+        float minTexture{4.0f};     // grey-level deviation a patch needs to match
+        bool rectifiedFrames{false};
+    };
+
+    DepthEstimator(std::shared_ptr<const StereoRectifier> rectifier, const Config& config);
+
+    // Builds its own full-size tables
+    DepthEstimator(const StereoCalibration& calibration, const Config& config);
+
+    DepthEstimator(const DepthEstimator&) = delete;
+    DepthEstimator& operator=(const DepthEstimator&) = delete;
+
+    // Sets distance on every detection, whose boxes are in pixels of the
+    // given eye's frame
+    void estimate(const cv::Mat& left, const cv::Mat& right, Eye eye,
+                  std::vector<YOLODetector::DetectionResult>& detections);
+
+    // Fills right with the left-eye detections moved to where the right
+    // eye sees them, index for index, and sets the distance on both. A box
+    // without a confident match is taken to be far away: its right box is
+    // not shifted and its distance stays 0 (unknown).
+    void project(const cv::Mat& left, const cv::Mat& right,
+                 std::vector<YOLODetector::DetectionResult>& leftDetections,
+                 std::vector<YOLODetector::DetectionResult>& rightDetections);
+
+private:
+    void checkFrames(const cv::Mat& left, const cv::Mat& right) const;
+    cv::Rect rectifiedBox(Eye eye, const cv::Rect& box) const;
+    float boxDistance(const cv::Mat& left, const cv::Mat& right, Eye eye, const cv::Rect& box);
+    bool matchBox(const cv::Mat& left, const cv::Mat& right, const cv::Rect& target,
+                  float& disparity);
+    void rectifyStrip(const cv::Mat& frame, Eye eye, const cv::Rect& strip, cv::Mat& gray);
+
+    std::shared_ptr<const StereoRectifier> rectifier_;
+    Config config_;
+    cv::Ptr<cv::StereoBM> matcher_;
+
+    // Scratch sized once for a whole rectified frame (scratchStorage_ on
+    // the first frame, when its type is known); every strip works in views
+    // of the top-left corner, so boxes of any size reuse the same buffers.
+    // StereoBM and matchTemplate still size their internal buffers to each
+    // strip.
+    cv::Mat scratchStorage_;
+    cv::Mat grayStorage_[2];
+    cv::Mat mirroredStorage_[2];
+    cv::Mat disparityStorage_;
+    cv::Mat scoresStorage_;
+    cv::Mat scratch_;
+    cv::Mat rectified_;  // scratch_ or a view of a rectified frame
+    cv::Mat gray_[2];
+    cv::Mat mirrored_[2];
+    cv::Mat disparity_;
+    cv::Mat scores_;
+    std::vector<int16_t> samples_;
+};
+
+} // namespace rt
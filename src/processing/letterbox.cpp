@@ -0,0 +1,77 @@
+#include "letterbox.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace rt {
+
+LetterboxTransform LetterboxTransform::compute(const cv::Size& source, const cv::Size& target) {
+    if (source.width <= 0 || source.height <= 0 || target.width <= 0 || target.height <= 0) {
+        throw std::invalid_argument("Letterbox needs non-empty source and target sizes");
+    }
+
+    LetterboxTransform transform;
+    transform.sourceSize = source;
+    transform.scale = std::min(static_cast<float>(target.width) / source.width,
+                               static_cast<float>(target.height) / source.height);
+
+    const int contentWidth = std::min(target.width,
+        static_cast<int>(std::lround(source.width * transform.scale)));
+    const int contentHeight = std::min(target.height,
+        static_cast<int>(std::lround(source.height * transform.scale)));
+    transform.padX = (target.width - contentWidth) / 2;
+    transform.padY = (target.height - contentHeight) / 2;
+    return transform;
+}
+
+cv::Rect LetterboxTransform::contentRect() const {
+    return cv::Rect(padX, padY,
+                    static_cast<int>(std::lround(sourceSize.width * scale)),
+                    static_cast<int>(std::lround(sourceSize.height * scale)));
+}
+
+cv::Rect LetterboxTransform::toSource(const cv::Rect& box) const {
+    const float inv = 1.0f / scale;
+    const int x0 = static_cast<int>(std::lround((box.x - padX) * inv));
+    const int y0 = static_cast<int>(std::lround((box.y - padY) * inv));
+    const int x1 = static_cast<int>(std::lround((box.x + box.width - padX) * inv));
+    const int y1 = static_cast<int>(std::lround((box.y + box.height - padY) * inv));
+
+    const int left = std::clamp(x0, 0, sourceSize.width);
+    const int top = std::clamp(y0, 0, sourceSize.height);
+    const int right = std::clamp(x1, 0, sourceSize.width);
+    const int bottom = std::clamp(y1, 0, sourceSize.height);
+    return cv::Rect(left, top, std::max(0, right - left), std::max(0, bottom - top));
+}
+
+LetterboxTransform letterbox(const cv::Mat& source, cv::Mat& dst, const cv::Scalar& padColor) {
+    if (source.empty() || dst.empty() || source.type() != dst.type()) {
+        throw std::invalid_argument("Letterbox needs a source and a pre-allocated destination of the same type");
+    }
+
+    const LetterboxTransform transform = LetterboxTransform::compute(source.size(), dst.size());
+    const cv::Rect content = transform.contentRect() & cv::Rect(0, 0, dst.cols, dst.rows);
+
+    // Resizing into the ROI writes straight into dst, no intermediate image
+    cv::Mat roi = dst(content);
+    cv::resize(source, roi, content.size(), 0, 0, cv::INTER_LINEAR);
+
+    // Only the border strips are painted; dst slots are reused every frame
+    if (content.y > 0) {
+        dst(cv::Rect(0, 0, dst.cols, content.y)).setTo(padColor);
+    }
+    if (content.y + content.height < dst.rows) {
+        dst(cv::Rect(0, content.y + content.height, dst.cols,
+                     dst.rows - content.y - content.height)).setTo(padColor);
+    }
+    if (content.x > 0) {
+        dst(cv::Rect(0, content.y, content.x, content.height)).setTo(padColor);
+    }
+    if (content.x + content.width < dst.cols) {
+        dst(cv::Rect(content.x + content.width, content.y,
+                     dst.cols - content.x - content.width, content.height)).setTo(padColor);
+    }
+    return transform;
+}
+
+} // namespace rt
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+namespace rt {
+
+// Geometry of a letterboxed network input: the source image is scaled by
+// one factor for both axes and centred, with padding on the short side.
+struct LetterboxTransform {
+    float scale{1.0f};
+    int padX{0};
+    int padY{0};
+    cv::Size sourceSize;
+
+    static LetterboxTransform compute(const cv::Size& source, const cv::Size& target);
+
+    // Area of the network input that holds image pixels
+    cv::Rect contentRect() const;
+
+    // Maps a box from network input pixels back to source pixels, clamped
+    // to the source image
+    cv::Rect toSource(const cv::Rect& box) const;
+};
+
+// Grey used by Darknet for letterbox padding
+const cv::Scalar kLetterboxPad(127, 127, 127);
+
+// Resizes source into dst (which must already have the target size and the
+// source's type) preserving aspect ratio, and paints the borders
+LetterboxTransform letterbox(const cv::Mat& source, cv::Mat& dst,
+                             const cv::Scalar& padColor = kLetterboxPad);
+
+} // namespace rt
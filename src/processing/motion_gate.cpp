@@ -0,0 +1,173 @@
+#include "motion_gate.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+#if RT_HAVE_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace rt {
+
+namespace {
+
+void countScalar(const uint8_t* a, const uint8_t* b, int width, uint8_t threshold,
+                 uint16_t* counts) {
+    for (int x = 0; x < width; ++x) {
+        const int diff = a[x] > b[x] ? a[x] - b[x] : b[x] - a[x];
+        counts[x >> 3] += diff > threshold;
+    }
+}
+
+#if RT_HAVE_X86_SIMD
+
+// |a - b| > t as 0/1 bytes, then _sad_epu8 against zero sums each group
+// of eight bytes, i.e. one cell
+void countSSE2(const uint8_t* a, const uint8_t* b, int width, uint8_t threshold,
+               uint16_t* counts) {
+    const __m128i t = _mm_set1_epi8(static_cast<char>(threshold));
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i zero = _mm_setzero_si128();
+
+    for (int x = 0; x < width; x += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + x));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + x));
+        const __m128i diff = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+        const __m128i still = _mm_cmpeq_epi8(_mm_subs_epu8(diff, t), zero);
+        const __m128i sums = _mm_sad_epu8(_mm_andnot_si128(still, one), zero);
+        counts[(x >> 3)] += static_cast<uint16_t>(_mm_cvtsi128_si32(sums));
+        counts[(x >> 3) + 1] += static_cast<uint16_t>(_mm_extract_epi16(sums, 4));
+    }
+}
+
+RT_TARGET_AVX2
+void countAVX2(const uint8_t* a, const uint8_t* b, int width, uint8_t threshold,
+               uint16_t* counts) {
+    const __m256i t = _mm256_set1_epi8(static_cast<char>(threshold));
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i zero = _mm256_setzero_si256();
+
+    for (int x = 0; x < width; x += 32) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + x));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + x));
+        const __m256i diff = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+        const __m256i still = _mm256_cmpeq_epi8(_mm256_subs_epu8(diff, t), zero);
+        const __m256i sums = _mm256_sad_epu8(_mm256_andnot_si256(still, one), zero);
+        uint16_t* cell = counts + (x >> 3);
+        cell[0] += static_cast<uint16_t>(_mm256_extract_epi16(sums, 0));
+        cell[1] += static_cast<uint16_t>(_mm256_extract_epi16(sums, 4));
+        cell[2] += static_cast<uint16_t>(_mm256_extract_epi16(sums, 8));
+        cell[3] += static_cast<uint16_t>(_mm256_extract_epi16(sums, 12));
+    }
+}
+
+#endif
+
+} // namespace
+
+MotionGate::MotionGate(const Config& config, SimdLevel level)
+    : config_(config)
+    , level_(std::min(level, detectSimdLevel()))
+    , count_(&countScalar) {
+    if (config.step <= 0 || config.maxSkipped < 0 ||
+        config.cellFraction < 0.0f || config.cellFraction > 1.0f) {
+        throw std::invalid_argument("Invalid motion gate configuration");
+    }
+
+#if RT_HAVE_X86_SIMD
+    if (level_ == SimdLevel::AVX2) {
+        count_ = &countAVX2;
+    } else if (level_ == SimdLevel::SSE2) {
+        count_ = &countSSE2;
+    }
+#endif
+}
+
+void MotionGate::thumbnail(const cv::Mat& frame) {
+    if (frame.size() != sourceSize_) {
+        // New geometry: resize buffers, and the old reference is useless
+        sourceSize_ = frame.size();
+        thumbSize_ = cv::Size((frame.cols + config_.step - 1) / config_.step,
+                              (frame.rows + config_.step - 1) / config_.step);
+        stride_ = (thumbSize_.width + kRowAlign - 1) / kRowAlign * kRowAlign;
+        current_.assign(static_cast<size_t>(stride_) * thumbSize_.height, 0);
+        reference_.assign(current_.size(), 0);
+        cellCounts_.resize(static_cast<size_t>(stride_ / kCellSize) *
+                           ((thumbSize_.height + kCellSize - 1) / kCellSize));
+        hasReference_ = false;
+    }
+
+    // YUYV carries luma in every other byte
+    if (frame.type() == CV_8UC2) {
+        for (int y = 0; y < thumbSize_.height; ++y) {
+            const uint8_t* src = frame.ptr<uint8_t>(y * config_.step);
+            uint8_t* dst = current_.data() + static_cast<size_t>(y) * stride_;
+            for (int x = 0; x < thumbSize_.width; ++x) {
+                dst[x] = src[2 * x * config_.step];
+            }
+        }
+        return;
+    }
+
+    // BT.601 luma in 8-bit fixed point; padding columns stay zero
+    for (int y = 0; y < thumbSize_.height; ++y) {
+        const uint8_t* src = frame.ptr<uint8_t>(y * config_.step);
+        uint8_t* dst = current_.data() + static_cast<size_t>(y) * stride_;
+        for (int x = 0; x < thumbSize_.width; ++x) {
+            const uint8_t* pixel = src + 3 * x * config_.step;
+            dst[x] = static_cast<uint8_t>((29 * pixel[0] + 150 * pixel[1] + 77 * pixel[2]) >> 8);
+        }
+    }
+}
+
+bool MotionGate::check(const cv::Mat& frame) {
+    if (frame.empty() || (frame.type() != CV_8UC3 && frame.type() != CV_8UC2)) {
+        throw std::invalid_argument("Motion gate needs a BGR8 or YUYV frame");
+    }
+    frames_.fetch_add(1, std::memory_order_relaxed);
+    thumbnail(frame);
+
+    if (!hasReference_) {
+        changedRegion_ = cv::Rect(cv::Point(), sourceSize_);
+        return true;
+    }
+
+    std::fill(cellCounts_.begin(), cellCounts_.end(), 0);
+    const int cellsPerRow = stride_ / kCellSize;
+    for (int y = 0; y < thumbSize_.height; ++y) {
+        const size_t offset = static_cast<size_t>(y) * stride_;
+        count_(current_.data() + offset, reference_.data() + offset, stride_,
+               config_.pixelThreshold, cellCounts_.data() + (y / kCellSize) * cellsPerRow);
+    }
+
+    const int cellScale = kCellSize * config_.step;
+    const uint16_t minCount = static_cast<uint16_t>(
+        std::max(1.0f, config_.cellFraction * kCellSize * kCellSize));
+    changedRegion_ = cv::Rect();
+    for (size_t i = 0; i < cellCounts_.size(); ++i) {
+        if (cellCounts_[i] >= minCount) {
+            const int cellX = static_cast<int>(i) % cellsPerRow;
+            const int cellY = static_cast<int>(i) / cellsPerRow;
+            changedRegion_ |= cv::Rect(cellX * cellScale, cellY * cellScale, cellScale, cellScale);
+        }
+    }
+    changedRegion_ &= cv::Rect(cv::Point(), sourceSize_);
+
+    return !changedRegion_.empty() || skippedInARow_ >= config_.maxSkipped;
+}
+
+void MotionGate::accept() {
+    current_.swap(reference_);
+    hasReference_ = true;
+    skippedInARow_ = 0;
+}
+
+void MotionGate::skip() {
+    skipped_.fetch_add(1, std::memory_order_relaxed);
+    ++skippedInARow_;
+}
+
+MotionGate::Stats MotionGate::stats() const {
+    return {frames_.load(std::memory_order_relaxed), skipped_.load(std::memory_order_relaxed)};
+}
+
+} // namespace rt
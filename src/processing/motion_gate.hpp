@@ -0,0 +1,90 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "../utils/cpu_features.hpp"
+
+namespace rt {
+
+// Decides whether a camera frame changed enough since detection last ran
+// on that camera to be worth running it again.
+//
+// Each frame is reduced to a luma thumbnail (every step-th pixel and row;
+// packed YUYV frames give their Y samples as they are) and compared with
+// the thumbnail of the last accepted frame in 8x8 thumbnail cells; a cell
+// changed when enough of its pixels differ by more than pixelThreshold.
+// The comparison of a thumbnail row counts the changed pixels of 2 (SSE2)
+// or 4 (AVX2) cells per instruction group.
+//
+// Comparing against the last accepted frame rather than the previous one
+// lets slow motion add up. Buffers are sized on the first frame and when
+// the frame size changes only.
+class MotionGate {
+public:
+    struct Config {
+        int step{4};                // source pixels per thumbnail pixel
+        uint8_t pixelThreshold{24}; // luma difference that counts as change
+        float cellFraction{0.1f};   // share of a cell's pixels that must change
+        int maxSkipped{30};         // force a detection after this many skips
+    };
+
+    struct Stats {
+        uint64_t frames{0};
+        uint64_t skipped{0};
+    };
+
+    explicit MotionGate(const Config& config, SimdLevel level = detectSimdLevel());
+
+    MotionGate(const MotionGate&) = delete;
+    MotionGate& operator=(const MotionGate&) = delete;
+
+    // Thumbnails the frame and compares it with the reference. Returns true
+    // when anything moved (see changedRegion()) or the skip limit is hit.
+    bool check(const cv::Mat& frame);
+
+    // Detection ran on the last checked frame: it becomes the reference
+    void accept();
+
+    // Detection was skipped; the previous results stand for this frame
+    void skip();
+
+    // Bounding box of the changed cells in source pixels; empty when none
+    const cv::Rect& changedRegion() const { return changedRegion_; }
+
+    Stats stats() const;
+    SimdLevel simdLevel() const { return level_; }
+
+    // Adds the number of pixels in a and b that differ by more than
+    // threshold to counts[x / 8]; width is a multiple of 32
+    using CountFn = void (*)(const uint8_t* a, const uint8_t* b, int width, uint8_t threshold,
+                             uint16_t* counts);
+
+private:
+    static constexpr int kCellSize = 8;
+    static constexpr int kRowAlign = 32;
+
+    void thumbnail(const cv::Mat& frame);
+
+    Config config_;
+    SimdLevel level_;
+    CountFn count_;
+
+    cv::Size sourceSize_;
+    cv::Size thumbSize_;
+    int stride_{0};  // thumbnail row pitch, zero padded to kRowAlign
+    std::vector<uint8_t> current_;
+    std::vector<uint8_t> reference_;
+    bool hasReference_{false};
+    std::vector<uint16_t> cellCounts_;
+
+    cv::Rect changedRegion_;
+    int skippedInARow_{0};
+
+    // Read by the monitor
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> skipped_{0};
+};
+
+} // namespace rt
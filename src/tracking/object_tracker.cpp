@@ -0,0 +1,167 @@
+#include "object_tracker.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace rt {
+
+namespace {
+
+// Uncertainty of a new track's velocity, (px/frame)^2
+constexpr float kInitialVelocityVariance = 100.0f;
+
+float iou(const cv::Rect& a, const cv::Rect& b) {
+    const int inter = (a & b).area();
+    const int unionArea = a.area() + b.area() - inter;
+    return unionArea > 0 ? static_cast<float>(inter) / unionArea : 0.0f;
+}
+
+} // namespace
+
+void KalmanBox::init(const cv::Rect& box, const Noise& noise) {
+    const float values[] = {box.x + box.width * 0.5f, box.y + box.height * 0.5f,
+                            static_cast<float>(box.width), static_cast<float>(box.height)};
+    for (size_t i = 0; i < axes_.size(); ++i) {
+        axes_[i] = {values[i], 0.0f, noise.measurement, 0.0f, kInitialVelocityVariance};
+    }
+}
+
+void KalmanBox::predict(const Noise& noise) {
+    // x' = F x, P' = F P F^T + Q with F = [1 1; 0 1]
+    for (Axis& axis : axes_) {
+        axis.value += axis.velocity;
+        axis.p00 += 2.0f * axis.p01 + axis.p11 + noise.position;
+        axis.p01 += axis.p11;
+        axis.p11 += noise.velocity;
+    }
+}
+
+void KalmanBox::correct(const cv::Rect& box, const Noise& noise) {
+    const float measured[] = {box.x + box.width * 0.5f, box.y + box.height * 0.5f,
+                              static_cast<float>(box.width), static_cast<float>(box.height)};
+    // H = [1 0]: only the position of each axis is observed
+    for (size_t i = 0; i < axes_.size(); ++i) {
+        Axis& axis = axes_[i];
+        const float residual = measured[i] - axis.value;
+        const float s = axis.p00 + noise.measurement;
+        const float k0 = axis.p00 / s;
+        const float k1 = axis.p01 / s;
+
+        axis.value += k0 * residual;
+        axis.velocity += k1 * residual;
+        axis.p11 -= k1 * axis.p01;
+        axis.p01 *= 1.0f - k0;
+        axis.p00 *= 1.0f - k0;
+    }
+}
+
+void KalmanBox::shift(float frames) {
+    // F = [1 dt; 0 1] with no Q; dt < 0 gives the inverse transform
+    for (Axis& axis : axes_) {
+        axis.value += frames * axis.velocity;
+        axis.p00 += 2.0f * frames * axis.p01 + frames * frames * axis.p11;
+        axis.p01 += frames * axis.p11;
+    }
+}
+
+cv::Rect KalmanBox::boxAt(float frames) const {
+    KalmanBox shifted = *this;
+    shifted.shift(frames);
+    return shifted.box();
+}
+
+cv::Rect KalmanBox::box() const {
+    const float width = std::max(axes_[2].value, 1.0f);
+    const float height = std::max(axes_[3].value, 1.0f);
+    return cv::Rect(static_cast<int>(std::lround(axes_[0].value - width * 0.5f)),
+                    static_cast<int>(std::lround(axes_[1].value - height * 0.5f)),
+                    static_cast<int>(std::lround(width)), static_cast<int>(std::lround(height)));
+}
+
+ObjectTracker::ObjectTracker(const Config& config)
+    : config_(config) {
+    if (config.iouThreshold <= 0.0f || config.iouThreshold > 1.0f ||
+        config.minHits < 1 || config.maxMisses < 0 || config.maxTracks == 0) {
+        throw std::invalid_argument("Invalid object tracker configuration");
+    }
+
+    tracks_.reserve(config.maxTracks);
+    matches_.reserve(config.maxTracks * config.maxDetections);
+    trackUsed_.reserve(config.maxTracks);
+    detectionUsed_.reserve(config.maxDetections);
+}
+
+void ObjectTracker::predict() {
+    for (Track& track : tracks_) {
+        track.filter.predict(config_.noise);
+        track.box = track.filter.box();
+        ++track.misses;
+    }
+
+    const auto stale = std::remove_if(tracks_.begin(), tracks_.end(), [this](const Track& track) {
+        return track.misses > config_.maxMisses;
+    });
+    tracks_.erase(stale, tracks_.end());
+}
+
+void ObjectTracker::update(const std::vector<YOLODetector::DetectionResult>& detections,
+                           float age) {
+    matches_.clear();
+    for (size_t t = 0; t < tracks_.size(); ++t) {
+        // Where the track was when the detections' frame was captured
+        const cv::Rect then = age > 0.0f ? tracks_[t].filter.boxAt(-age) : tracks_[t].box;
+        for (size_t d = 0; d < detections.size(); ++d) {
+            if (detections[d].classId != tracks_[t].classId) {
+                continue;
+            }
+            const float overlap = iou(then, detections[d].box);
+            if (overlap >= config_.iouThreshold) {
+                matches_.push_back({overlap, static_cast<int>(t), static_cast<int>(d)});
+            }
+        }
+    }
+
+    // Greedy assignment, most overlapping pairs first
+    std::sort(matches_.begin(), matches_.end(), [](const Match& a, const Match& b) {
+        return a.iou > b.iou;
+    });
+    trackUsed_.assign(tracks_.size(), 0);
+    detectionUsed_.assign(detections.size(), 0);
+    for (const Match& match : matches_) {
+        if (trackUsed_[match.track] || detectionUsed_[match.detection]) {
+            continue;
+        }
+        trackUsed_[match.track] = 1;
+        detectionUsed_[match.detection] = 1;
+
+        Track& track = tracks_[match.track];
+        const auto& detection = detections[match.detection];
+        track.filter.shift(-age);
+        track.filter.correct(detection.box, config_.noise);
+        track.filter.shift(age);
+        track.box = track.filter.box();
+        track.confidence = detection.confidence;
+        track.distance = detection.distance;
+        track.misses = 0;
+        track.confirmed = ++track.hits >= config_.minHits;
+    }
+
+    // Every unmatched detection starts a tentative track
+    for (size_t d = 0; d < detections.size(); ++d) {
+        if (detectionUsed_[d]) {
+            continue;
+        }
+        if (tracks_.size() == config_.maxTracks) {
+            ++dropped_;
+            continue;
+        }
+
+        const auto& detection = detections[d];
+        Track track{nextId_++, detection.classId, detection.className, detection.confidence,
+                    detection.distance, detection.box, 1, 0, config_.minHits <= 1, KalmanBox()};
+        track.filter.init(detection.box, config_.noise);
+        tracks_.push_back(std::move(track));
+    }
+}
+
+} // namespace rt
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "../detection/yolo_detector.hpp"
+
+namespace rt {
+
+// Constant-velocity Kalman filter over a box's centre and size. The four
+// axes are filtered independently (2x2 covariance each), which is all a
+// constant-velocity box model needs and keeps the filter allocation-free.
+class KalmanBox {
+public:
+    struct Noise {
+        float position;     // process noise on each coordinate, px^2
+        float velocity;     // process noise on each velocity, (px/frame)^2
+        float measurement;  // detection jitter, px^2
+    };
+
+    void init(const cv::Rect& box, const Noise& noise);
+    void predict(const Noise& noise);  // advances one frame
+    void correct(const cv::Rect& box, const Noise& noise);
+    cv::Rect box() const;
+
+    // Moves the estimate along its velocity by a number of frames, negative
+    // to go back in time, without adding process noise
+    void shift(float frames);
+    cv::Rect boxAt(float frames) const;  // box() after shift(frames)
+
+private:
+    struct Axis {
+        float value;
+        float velocity;
+        float p00, p01, p11;  // covariance
+    };
+    std::array<Axis, 4> axes_;  // centre x, centre y, width, height
+};
+
+// Associates detections across frames and keeps every object moving on
+// frames without detection, so the output updates at capture rate while
+// the detector runs at a fraction of it.
+//
+// Call predict() once per frame and update() on frames that have fresh
+// detections. Detections that arrive late are matched against where each
+// track was when their frame was captured, and the corrected track is then
+// carried forward to now. Matching is greedy on IoU between those track
+// boxes and detections of the same class, best pairs first. Tracks become
+// confirmed after minHits detections and are dropped after maxMisses frames
+// without one. Storage is reserved up front for maxTracks tracks.
+class ObjectTracker {
+public:
+    struct Config {
+        float iouThreshold{0.3f};
+        int minHits{2};
+        int maxMisses{5};
+        size_t maxTracks{128};
+        size_t maxDetections{128};
+        KalmanBox::Noise noise{1.0f, 0.25f, 4.0f};
+    };
+
+    struct Track {
+        int id;
+        int classId;
+        std::string className;
+        float confidence;   // of the last associated detection
+        float distance;     // of the last associated detection, 0 if unknown
+        cv::Rect box;       // current estimate
+        int hits;           // detections associated so far
+        int misses;         // frames since the last one
+        bool confirmed;
+        KalmanBox filter;
+    };
+
+    explicit ObjectTracker(const Config& config);
+
+    void predict();
+    // age: frames (predict() calls) since the detections' frame was captured
+    void update(const std::vector<YOLODetector::DetectionResult>& detections,
+                float age = 0.0f);
+
+    // Includes tentative tracks; output usually wants confirmed ones only
+    const std::vector<Track>& tracks() const { return tracks_; }
+    size_t dropped() const { return dropped_; }  // new tracks refused when full
+
+private:
+    struct Match {
+        float iou;
+        int track;
+        int detection;
+    };
+
+    Config config_;
+    std::vector<Track> tracks_;
+    int nextId_{1};
+    size_t dropped_{0};
+
+    // Association scratch
+    std::vector<Match> matches_;
+    std::vector<char> detectionUsed_;
+    std::vector<char> trackUsed_;
+};
+
+} // namespace rt
@@ -0,0 +1,38 @@
+#include "cpu_features.hpp"
+
+namespace rt {
+
+namespace {
+
+SimdLevel probeSimdLevel() {
+#if RT_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SimdLevel::SSE2;
+    }
+#endif
+    return SimdLevel::Scalar;
+}
+
+} // namespace
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel level = probeSimdLevel();
+    return level;
+}
+
+const char* toString(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2:
+            return "AVX2";
+        case SimdLevel::SSE2:
+            return "SSE2";
+        default:
+            return "scalar";
+    }
+}
+
+} // namespace rt
@@ -0,0 +1,26 @@
+#pragma once
+
+namespace rt {
+
+// Instruction sets the hand-written kernels can dispatch to, best last
+enum class SimdLevel {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Best level supported by both this build and the CPU; detected once
+SimdLevel detectSimdLevel();
+
+const char* toString(SimdLevel level);
+
+} // namespace rt
+
+// x86 kernels are compiled per function with target attributes, so the
+// library itself needs no global -mavx2 and still runs on older CPUs
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define RT_HAVE_X86_SIMD 1
+#define RT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define RT_HAVE_X86_SIMD 0
+#endif
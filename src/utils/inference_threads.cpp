@@ -0,0 +1,85 @@
+#include "inference_threads.hpp"
+#include <opencv2/core.hpp>
+#include <opencv2/core/utility.hpp>
+#include <pthread.h>
+#include <sched.h>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace rt {
+
+namespace {
+
+cpu_set_t toCpuSet(CpuMask mask) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < 64; ++cpu) {
+        if (mask & (CpuMask{1} << cpu)) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return set;
+}
+
+void setCurrentAffinity(const cpu_set_t& set) {
+    const int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (ret != 0) {
+        throw std::runtime_error("Failed to set inference thread affinity: " +
+                                 std::to_string(ret));
+    }
+}
+
+} // namespace
+
+CpuMask currentCpuMask() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+
+    CpuMask mask = 0;
+    for (int cpu = 0; cpu < 64; ++cpu) {
+        if (CPU_ISSET(cpu, &set)) {
+            mask |= CpuMask{1} << cpu;
+        }
+    }
+    return mask;
+}
+
+int configureInferenceThreads(int threads, CpuMask cpuMask) {
+    if (threads < 0) {
+        throw std::invalid_argument("Inference thread count must not be negative");
+    }
+    if (cpuMask == 0) {
+        if (threads > 0) {
+            cv::setNumThreads(threads);
+        }
+        return cv::getNumThreads();
+    }
+
+    const int cores = __builtin_popcountll(cpuMask);
+    if (threads == 0 || threads > cores) {
+        threads = cores;
+    }
+
+    cpu_set_t original;
+    CPU_ZERO(&original);
+    pthread_getaffinity_np(pthread_self(), sizeof(original), &original);
+    setCurrentAffinity(toCpuSet(cpuMask));
+
+    // Resizing drops the old pool; the next parallel region starts new
+    // workers, which inherit the mask set above
+    cv::setNumThreads(threads);
+    cv::parallel_for_(cv::Range(0, threads), [](const cv::Range&) {}, threads);
+
+    setCurrentAffinity(original);
+    return cv::getNumThreads();
+}
+
+bool inferenceMaskApplies() {
+    // Without a backend everything runs on the calling thread
+    const char* framework = cv::currentParallelFramework();
+    return framework == nullptr || std::strcmp(framework, "pthreads") == 0;
+}
+
+} // namespace rt
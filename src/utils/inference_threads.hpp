@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+namespace rt {
+
+// CPU set as a bit mask, bit n = core n; 0 means "leave as is"
+using CpuMask = uint64_t;
+
+// Sizes OpenCV's parallel_for pool and confines its workers to cpuMask.
+//
+// OpenCV has no affinity API; its workers inherit the mask of the thread
+// that starts them. So this narrows the calling thread's affinity, starts
+// the pool with one dummy parallel_for, and restores the caller. Call it
+// before any RT task runs. The pool is process-wide, so the last call
+// wins for every detector.
+//
+// threads == 0 keeps OpenCV's default count. More threads than cores in
+// the mask would only time-slice, so the count is capped at the mask.
+// Returns the thread count OpenCV actually uses.
+//
+// Only OpenCV's own pthreads pool starts its workers here; TBB and OpenMP
+// keep pools of their own, so with those backends the count still applies
+// but the mask does not (see inferenceMaskApplies()).
+int configureInferenceThreads(int threads, CpuMask cpuMask);
+
+// Whether OpenCV's parallel backend honours the mask given above
+bool inferenceMaskApplies();
+
+// Cores the calling thread may run on
+CpuMask currentCpuMask();
+
+} // namespace rt
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace rt {
+
+// Bounded single-producer/single-consumer ring of pre-allocated slots.
+//
+// Slots are constructed once and then reused forever: the producer fills
+// the slot returned by beginWrite() in place and publishes it with
+// commitWrite(); the consumer works on front() in place and hands the slot
+// back with pop(). Buffer ownership therefore moves between pipeline stages
+// without locks, copies or allocation.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() = default;
+
+    // Runs init on every slot so payloads can be allocated up front
+    template <typename Init>
+    explicit SpscQueue(Init&& init) {
+        for (auto& slot : slots_) {
+            init(slot);
+        }
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side: returns nullptr (and counts an overrun) when full
+    T* beginWrite() {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+            overruns_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &slots_[tail & kMask];
+    }
+
+    void commitWrite() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+    }
+
+    // Consumer side: returns nullptr when empty
+    T* front() {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &slots_[head & kMask];
+    }
+
+    void pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1,
+                    std::memory_order_release);
+    }
+
+    // Consumer side: discard everything but the newest published slot
+    void dropStale() {
+        while (size() > 1) {
+            pop();
+        }
+    }
+
+    // Runs fn on every slot, published or not. Only while neither side is
+    // running, e.g. to release what the slots hold at shutdown.
+    template <typename Fn>
+    void forEachSlot(Fn&& fn) {
+        for (auto& slot : slots_) {
+            fn(slot);
+        }
+    }
+
+    std::size_t size() const {
+        return tail_.load(std::memory_order_acquire) -
+               head_.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+    uint64_t overruns() const { return overruns_.load(std::memory_order_relaxed); }
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    static constexpr std::size_t kMask = Capacity - 1;
+
+    // Producer and consumer indices live on separate cache lines
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    alignas(64) std::atomic<uint64_t> overruns_{0};
+
+    std::array<T, Capacity> slots_;
+};
+
+} // namespace rt
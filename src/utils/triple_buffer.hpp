@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace rt {
+
+// Wait-free single-writer/single-reader publication of the latest value.
+//
+// The writer fills back() and publish()es it; the reader calls update() to
+// adopt the newest published buffer as front(). Publishing and reading are
+// a single atomic index exchange each, so neither side ever blocks or
+// copies, and the reader always sees a complete value.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    // Runs init on all three buffers so payloads can be allocated up front
+    template <typename Init>
+    explicit TripleBuffer(Init&& init) {
+        for (auto& buffer : buffers_) {
+            init(buffer);
+        }
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer side
+    T& back() { return buffers_[backIndex_]; }
+
+    void publish() {
+        const uint8_t previous = middle_.exchange(backIndex_ | kFresh,
+                                                  std::memory_order_acq_rel);
+        backIndex_ = previous & kIndexMask;
+    }
+
+    // Reader side: returns true if a newer value became front()
+    bool update() {
+        if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0) {
+            return false;
+        }
+        const uint8_t previous = middle_.exchange(frontIndex_,
+                                                  std::memory_order_acq_rel);
+        frontIndex_ = previous & kIndexMask;
+        return true;
+    }
+
+    T& front() { return buffers_[frontIndex_]; }
+    const T& front() const { return buffers_[frontIndex_]; }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;
+
+    std::array<T, 3> buffers_;
+
+    // The middle index is shared; back and front are private to each side
+    alignas(64) std::atomic<uint8_t> middle_{1};
+    alignas(64) uint8_t backIndex_{0};
+    alignas(64) uint8_t frontIndex_{2};
+};
+
+} // namespace rt
@@ -1,6 +1,13 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "camera/stereo_capture.hpp"
+#include "camera/stereo_synchronizer.hpp"
+#include "camera/replay_frame_source.hpp"
+#include "camera/stereo_overlay.hpp"
+#include "camera/stereo_calibration.hpp"
+#include "camera/stereo_rectifier.hpp"
+#include <cstdio>
+#include <fstream>
 
 using namespace rt;
 using namespace testing;
@@ -133,4 +140,535 @@ TEST_F(StereoCameraTest, PerformanceTest) {
     double fps = 1000.0 * successfulCaptures / duration.count();
     EXPECT_GT(fps, 25.0);  // Should achieve at least 25 FPS
     EXPECT_GT(successfulCaptures, numFrames * 0.9);  // 90% success rate
-} 
\ No newline at end of file
+} 
+
+TEST(FramePoolTest, FramesArePreallocated) {
+    FramePool pool(4, 640, 480);
+    
+    auto handle = pool.acquire();
+    ASSERT_TRUE(handle);
+    EXPECT_EQ(handle.frame().rows, 480);
+    EXPECT_EQ(handle.frame().cols, 640);
+    EXPECT_EQ(handle.frame().type(), CV_8UC3);
+    EXPECT_EQ(pool.available(), 3u);
+}
+
+TEST(FramePoolTest, FramesAreRecycled) {
+    FramePool pool(2, 64, 48);
+    
+    const uchar* first = nullptr;
+    {
+        auto handle = pool.acquire();
+        first = handle.frame().data;
+    }
+    EXPECT_EQ(pool.available(), 2u);
+    
+    // Cycling through the pool never allocates new pixel memory
+    for (int i = 0; i < 10; ++i) {
+        auto a = pool.acquire();
+        auto b = pool.acquire();
+        ASSERT_TRUE(a && b);
+        EXPECT_TRUE(a.frame().data == first || b.frame().data == first);
+    }
+}
+
+TEST(FramePoolTest, SharedHandlesKeepFrameAlive) {
+    FramePool pool(1, 64, 48);
+    
+    auto handle = pool.acquire();
+    FramePool::Handle copy = handle;
+    handle.reset();
+    EXPECT_EQ(pool.available(), 0u);
+    
+    copy.reset();
+    EXPECT_EQ(pool.available(), 1u);
+}
+
+TEST(FramePoolTest, ExhaustionIsCounted) {
+    FramePool pool(2, 64, 48);
+    
+    auto a = pool.acquire();
+    auto b = pool.acquire();
+    auto c = pool.acquire();
+    
+    EXPECT_FALSE(c);
+    EXPECT_EQ(pool.exhaustionCount(), 1u);
+}
+
+class StereoSynchronizerTest : public Test {
+protected:
+    FramePool::Handle frameAt(FramePool& pool, uint64_t sequence, int64_t timestampMs) {
+        auto handle = pool.acquire();
+        handle.stamp(sequence, std::chrono::milliseconds(timestampMs));
+        return handle;
+    }
+    
+    FramePool leftPool{8, 64, 48};
+    FramePool rightPool{8, 64, 48};
+    StereoSynchronizer sync{{std::chrono::milliseconds(5)}};
+};
+
+TEST_F(StereoSynchronizerTest, MatchesFramesWithinSkewWindow) {
+    sync.pushLeft(frameAt(leftPool, 1, 100));
+    sync.pushRight(frameAt(rightPool, 1, 103));
+    
+    StereoSynchronizer::StereoPair pair;
+    ASSERT_TRUE(sync.tryMatch(pair));
+    EXPECT_EQ(pair.left.sequence(), 1u);
+    EXPECT_EQ(pair.right.sequence(), 1u);
+    EXPECT_EQ(pair.skew, std::chrono::milliseconds(-3));
+    EXPECT_FALSE(sync.tryMatch(pair));
+}
+
+TEST_F(StereoSynchronizerTest, WaitsForMissingEye) {
+    sync.pushLeft(frameAt(leftPool, 1, 100));
+    
+    StereoSynchronizer::StereoPair pair;
+    EXPECT_FALSE(sync.tryMatch(pair));
+    
+    sync.pushRight(frameAt(rightPool, 1, 101));
+    EXPECT_TRUE(sync.tryMatch(pair));
+}
+
+TEST_F(StereoSynchronizerTest, DropsStragglers) {
+    // Left frame at 100ms has no partner; right stream starts at 133ms
+    sync.pushLeft(frameAt(leftPool, 1, 100));
+    sync.pushLeft(frameAt(leftPool, 2, 133));
+    sync.pushRight(frameAt(rightPool, 1, 134));
+    
+    StereoSynchronizer::StereoPair pair;
+    ASSERT_TRUE(sync.tryMatch(pair));
+    EXPECT_EQ(pair.left.sequence(), 2u);
+    
+    auto stats = sync.getStats();
+    EXPECT_EQ(stats.matchedPairs, 1u);
+    EXPECT_EQ(stats.droppedLeft, 1u);
+    EXPECT_EQ(stats.droppedRight, 0u);
+    EXPECT_EQ(stats.maxSkew, std::chrono::milliseconds(1));
+}
+
+TEST_F(StereoSynchronizerTest, DroppedFramesReturnToPool) {
+    sync.pushRight(frameAt(rightPool, 1, 100));
+    sync.pushLeft(frameAt(leftPool, 1, 200));
+    
+    StereoSynchronizer::StereoPair pair;
+    EXPECT_FALSE(sync.tryMatch(pair));
+    EXPECT_EQ(rightPool.available(), rightPool.capacity());
+    EXPECT_EQ(sync.getStats().droppedRight, 1u);
+}
+
+TEST_F(StereoSynchronizerTest, MatchNewestSkipsOlderPairs) {
+    sync.pushLeft(frameAt(leftPool, 1, 100));
+    sync.pushLeft(frameAt(leftPool, 2, 133));
+    sync.pushRight(frameAt(rightPool, 1, 101));
+    sync.pushRight(frameAt(rightPool, 2, 134));
+    
+    StereoSynchronizer::StereoPair pair;
+    ASSERT_TRUE(sync.tryMatchNewest(pair));
+    EXPECT_EQ(pair.left.sequence(), 2u);
+    EXPECT_EQ(leftPool.available(), leftPool.capacity() - 1);  // only the emitted pair
+    
+    auto stats = sync.getStats();
+    EXPECT_EQ(stats.matchedPairs, 1u);
+    EXPECT_EQ(stats.skippedPairs, 1u);
+    EXPECT_FALSE(sync.tryMatchNewest(pair));
+}
+
+TEST_F(StereoSynchronizerTest, ClearReturnsPendingFrames) {
+    sync.pushLeft(frameAt(leftPool, 1, 100));
+    sync.pushLeft(frameAt(leftPool, 2, 133));
+    sync.pushRight(frameAt(rightPool, 1, 300));
+    
+    sync.clear();
+    EXPECT_EQ(leftPool.available(), leftPool.capacity());
+    EXPECT_EQ(rightPool.available(), rightPool.capacity());
+    StereoSynchronizer::StereoPair pair;
+    EXPECT_FALSE(sync.tryMatch(pair));
+}
+
+class ReplayFrameSourceTest : public Test {
+protected:
+    void SetUp() override {
+        // Raw dump of numFrames BGR8 frames, frame i filled with value i
+        path = testing::TempDir() + "replay_test.raw";
+        std::ofstream out(path, std::ios::binary);
+        for (int i = 0; i < numFrames; ++i) {
+            std::vector<char> pixels(width * height * 3, static_cast<char>(i));
+            out.write(pixels.data(), pixels.size());
+        }
+    }
+    
+    void TearDown() override {
+        std::remove(path.c_str());
+    }
+    
+    ReplayFrameSource::Config makeConfig(ReplayFrameSource::Pacing pacing, bool loop) {
+        return ReplayFrameSource::Config{
+            .path = path,
+            .width = width,
+            .height = height,
+            .fps = 30.0,
+            .pacing = pacing,
+            .loop = loop
+        };
+    }
+    
+    const int width = 64;
+    const int height = 48;
+    const int numFrames = 5;
+    std::string path;
+};
+
+TEST_F(ReplayFrameSourceTest, ReadsRawFramesInOrder) {
+    ReplayFrameSource source(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false));
+    cv::Mat frame(height, width, CV_8UC3);
+    std::chrono::nanoseconds timestamp;
+    
+    for (int i = 0; i < numFrames; ++i) {
+        ASSERT_TRUE(source.read(frame, timestamp));
+        EXPECT_EQ(frame.at<cv::Vec3b>(10, 10)[0], i);
+    }
+    EXPECT_FALSE(source.read(frame, timestamp));
+}
+
+TEST_F(ReplayFrameSourceTest, TimestampsAreDeterministic) {
+    ReplayFrameSource source(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, true));
+    cv::Mat frame;
+    std::chrono::nanoseconds timestamp;
+    
+    const auto period = std::chrono::nanoseconds(static_cast<int64_t>(1e9 / 30.0));
+    for (int i = 0; i < 2 * numFrames; ++i) {
+        ASSERT_TRUE(source.read(frame, timestamp));
+        EXPECT_EQ(timestamp, period * i);
+        EXPECT_EQ(frame.at<cv::Vec3b>(0, 0)[0], i % numFrames);  // Loops
+    }
+}
+
+TEST_F(ReplayFrameSourceTest, RealTimePacing) {
+    ReplayFrameSource source(makeConfig(ReplayFrameSource::Pacing::RealTime, false));
+    cv::Mat frame;
+    std::chrono::nanoseconds timestamp;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numFrames; ++i) {
+        ASSERT_TRUE(source.read(frame, timestamp));
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    
+    // First frame is immediate, the rest arrive one period apart
+    EXPECT_GE(elapsed, std::chrono::milliseconds(4 * 33));
+}
+
+TEST_F(ReplayFrameSourceTest, DrivesStereoCaptureSystem) {
+    StereoCaptureSystem::CameraConfig config{
+        .deviceId = -1, .width = width, .height = height, .fps = 30, .cpuCore = 0
+    };
+    StereoCaptureSystem system(
+        std::make_unique<ReplayFrameSource>(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false)),
+        std::make_unique<ReplayFrameSource>(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false)),
+        config, config);
+    
+    StereoSynchronizer sync({std::chrono::milliseconds(1)});
+    for (int i = 0; i < numFrames; ++i) {
+        FramePool::Handle left, right;
+        ASSERT_TRUE(system.captureLeftFrame(left));
+        ASSERT_TRUE(system.captureRightFrame(right));
+        EXPECT_EQ(left.sequence(), static_cast<uint64_t>(i + 1));
+        sync.pushLeft(std::move(left));
+        sync.pushRight(std::move(right));
+    }
+    
+    // Replayed eyes share a virtual clock, so every frame pairs up exactly
+    StereoSynchronizer::StereoPair pair;
+    int pairs = 0;
+    while (sync.tryMatch(pair)) {
+        EXPECT_EQ(pair.skew.count(), 0);
+        ++pairs;
+    }
+    EXPECT_EQ(pairs, numFrames);
+}
+
+TEST_F(ReplayFrameSourceTest, GrabsThenRetrievesInPairs) {
+    ReplayFrameSource source(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false));
+    cv::Mat frame;
+    std::chrono::nanoseconds timestamp;
+    
+    // Frames are only read on retrieve, and the stream ends at a grab
+    for (int i = 0; i < numFrames; ++i) {
+        ASSERT_TRUE(source.grab(timestamp));
+        ASSERT_TRUE(source.retrieve(frame));
+        EXPECT_EQ(frame.at<cv::Vec3b>(0, 0)[0], i);
+    }
+    EXPECT_FALSE(source.grab(timestamp));
+}
+
+TEST_F(ReplayFrameSourceTest, TriggeredCaptureRetrievesInParallel) {
+    StereoCaptureSystem::CameraConfig config{
+        .deviceId = -1, .width = width, .height = height, .fps = 30, .cpuCore = 0
+    };
+    StereoCaptureSystem system(
+        std::make_unique<ReplayFrameSource>(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false)),
+        std::make_unique<ReplayFrameSource>(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false)),
+        config, config);
+    
+    StereoSynchronizer sync({std::chrono::milliseconds(1)});
+    for (int i = 0; i < numFrames; ++i) {
+        ASSERT_TRUE(system.grabPair());
+        FramePool::Handle left, right;
+        bool rightRetrieved = false;
+        std::thread rightEye([&] { rightRetrieved = system.retrieveRightFrame(right); });
+        const bool leftRetrieved = system.retrieveLeftFrame(left);
+        rightEye.join();
+        ASSERT_TRUE(leftRetrieved);
+        ASSERT_TRUE(rightRetrieved);
+        
+        EXPECT_EQ(left.sequence(), static_cast<uint64_t>(i + 1));
+        EXPECT_EQ(left.frame().at<cv::Vec3b>(0, 0)[0], i);
+        EXPECT_EQ(right.frame().at<cv::Vec3b>(0, 0)[0], i);
+        sync.pushLeft(std::move(left));
+        sync.pushRight(std::move(right));
+    }
+    EXPECT_FALSE(system.grabPair());
+    
+    // Replayed grabs share the virtual clock, so the measured skew is zero
+    const StereoCaptureSystem::GrabStats stats = system.getGrabStats();
+    EXPECT_EQ(stats.pairs, static_cast<uint64_t>(numFrames));
+    EXPECT_EQ(stats.maxSkew.count(), 0);
+    EXPECT_EQ(stats.skippedTriggers, 0u);
+    StereoSynchronizer::StereoPair pair;
+    int pairs = 0;
+    while (sync.tryMatch(pair)) {
+        EXPECT_EQ(pair.skew.count(), 0);
+        ++pairs;
+    }
+    EXPECT_EQ(pairs, numFrames);
+}
+
+TEST_F(ReplayFrameSourceTest, SkipsTriggersWhileRightRetrievePending) {
+    StereoCaptureSystem::CameraConfig config{
+        .deviceId = -1, .width = width, .height = height, .fps = 30, .cpuCore = 0
+    };
+    StereoCaptureSystem system(
+        std::make_unique<ReplayFrameSource>(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false)),
+        std::make_unique<ReplayFrameSource>(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false)),
+        config, config);
+    FramePool::Handle left, right;
+    
+    ASSERT_TRUE(system.grabPair());
+    ASSERT_TRUE(system.retrieveLeftFrame(left));
+    EXPECT_FALSE(system.grabPair());  // The right eye still owns the pair
+    ASSERT_TRUE(system.retrieveRightFrame(right));
+    EXPECT_EQ(right.frame().at<cv::Vec3b>(0, 0)[0], 0);
+    
+    // A right frame given up also frees the trigger
+    ASSERT_TRUE(system.grabPair());
+    system.skipRightFrame();
+    ASSERT_TRUE(system.grabPair());
+    
+    const StereoCaptureSystem::GrabStats stats = system.getGrabStats();
+    EXPECT_EQ(stats.pairs, 3u);
+    EXPECT_EQ(stats.skippedTriggers, 1u);
+}
+
+TEST_F(ReplayFrameSourceTest, KeepsYuyvPackedUntilDisplayed) {
+    // Mid grey with a blue cast, as a camera would deliver it
+    const std::string yuyvPath = testing::TempDir() + "replay_test_yuyv.raw";
+    cv::Mat packed(height, width, CV_8UC2, cv::Scalar(128, 128));
+    for (int x = 0; x < width; x += 2) {
+        packed.col(x).setTo(cv::Scalar(128, 200));
+    }
+    {
+        std::ofstream out(yuyvPath, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(packed.data), packed.total() * packed.elemSize());
+    }
+    
+    ReplayFrameSource::Config replay = makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false);
+    replay.path = yuyvPath;
+    replay.format = PixelFormat::YUYV;
+    StereoCaptureSystem::CameraConfig config{
+        .deviceId = -1, .width = width, .height = height, .fps = 30, .cpuCore = 0,
+        .format = PixelFormat::YUYV
+    };
+    StereoCaptureSystem system(std::make_unique<ReplayFrameSource>(replay),
+                               std::make_unique<ReplayFrameSource>(replay), config, config);
+    
+    EXPECT_EQ(system.frameType(), CV_8UC2);
+    FramePool::Handle left, right;
+    ASSERT_TRUE(system.captureLeftFrame(left));
+    ASSERT_TRUE(system.captureRightFrame(right));
+    EXPECT_EQ(left.frame().type(), CV_8UC2);
+    EXPECT_EQ(cv::norm(left.frame(), packed, cv::NORM_INF), 0.0);
+    
+    // Only the reader of the merged view converts
+    ASSERT_TRUE(system.updateMergedView(left.frame(), true));
+    ASSERT_TRUE(system.updateMergedView(right.frame(), false));
+    cv::Mat expected;
+    cv::cvtColor(packed, expected, cv::COLOR_YUV2BGR_YUY2);
+    cv::Mat merged = system.getMergedFrame();
+    ASSERT_EQ(merged.type(), CV_8UC3);
+    EXPECT_EQ(cv::norm(merged(cv::Rect(width, 0, width, height)), expected, cv::NORM_INF), 0.0);
+    
+    // A BGR frame is not a packed camera frame
+    EXPECT_FALSE(system.updateMergedView(cv::Mat(height, width, CV_8UC3), true));
+    std::remove(yuyvPath.c_str());
+}
+
+TEST_F(ReplayFrameSourceTest, MergedViewPublishesCompletePairs) {
+    StereoCaptureSystem::CameraConfig config{
+        .deviceId = -1, .width = width, .height = height, .fps = 30, .cpuCore = 0
+    };
+    StereoCaptureSystem system(
+        std::make_unique<ReplayFrameSource>(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false)),
+        std::make_unique<ReplayFrameSource>(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false)),
+        config, config);
+    
+    cv::Mat left(height, width, CV_8UC3, cv::Scalar(255, 0, 0));
+    cv::Mat right(height, width, CV_8UC3, cv::Scalar(0, 255, 0));
+    
+    // A lone left half is not a complete view yet
+    ASSERT_TRUE(system.updateMergedView(left, true));
+    EXPECT_EQ(system.getMergedFrame().at<cv::Vec3b>(height - 1, 0)[0], 0);
+    
+    ASSERT_TRUE(system.updateMergedView(right, false));
+    cv::Mat merged = system.getMergedFrame();
+    EXPECT_EQ(merged.cols, 2 * width);
+    EXPECT_EQ(merged.at<cv::Vec3b>(height - 1, 0)[0], 255);
+    EXPECT_EQ(merged.at<cv::Vec3b>(height - 1, 2 * width - 1)[1], 255);
+}
+
+TEST(StereoOverlayTest, AnnotatesOnlyTheGivenView) {
+    StereoOverlay overlay(640, 480);
+    cv::Mat clean(480, 1280, CV_8UC3, cv::Scalar(0, 0, 0));
+    cv::Mat view = clean.clone();
+    
+    overlay.apply(view);
+    
+    // Separator drawn between the eyes, labels near the top of each eye
+    EXPECT_EQ(view.at<cv::Vec3b>(240, 640)[1], 255);
+    EXPECT_GT(cv::countNonZero(view(cv::Rect(0, 0, 640, 60)).reshape(1)), 0);
+    EXPECT_GT(cv::countNonZero(view(cv::Rect(641, 0, 639, 60)).reshape(1)), 0);
+    EXPECT_EQ(cv::countNonZero(view(cv::Rect(0, 100, 600, 380)).reshape(1)), 0);
+    EXPECT_EQ(cv::countNonZero(clean.reshape(1)), 0);
+}
+
+TEST(StereoCalibrationTest, LoadsRigAndRectifies) {
+    // Ideal rig: 500px focal length, cameras 0.1 apart, no distortion
+    const std::string path = testing::TempDir() + "stereo_calibration.yml";
+    {
+        cv::FileStorage file(path, cv::FileStorage::WRITE);
+        const cv::Mat matrix = (cv::Mat_<double>(3, 3) << 500, 0, 320, 0, 500, 240, 0, 0, 1);
+        file << "image_width" << 640 << "image_height" << 480;
+        file << "M1" << matrix << "D1" << cv::Mat::zeros(1, 5, CV_64F);
+        file << "M2" << matrix << "D2" << cv::Mat::zeros(1, 5, CV_64F);
+        file << "R" << cv::Mat::eye(3, 3, CV_64F);
+        file << "T" << (cv::Mat_<double>(3, 1) << -0.1, 0, 0);
+    }
+    
+    const StereoCalibration calibration = StereoCalibration::load(path);
+    std::remove(path.c_str());
+    
+    EXPECT_EQ(calibration.imageSize(), cv::Size(640, 480));
+    EXPECT_NEAR(calibration.baseline(), 0.1, 1e-9);
+    EXPECT_NEAR(calibration.distance(20.0), calibration.focalLength() * 0.1 / 20.0, 1e-9);
+    
+    // Already rectified, so boxes map onto themselves up to the new focal length
+    const cv::Rect box = calibration.rectify(calibration.left(), cv::Rect(300, 220, 40, 40));
+    EXPECT_NEAR(box.x + box.width / 2, 320, 1);
+    EXPECT_NEAR(box.y + box.height / 2, 240, 1);
+    EXPECT_NEAR(box.width, 40 * calibration.focalLength() / 500.0, 2);
+}
+
+TEST(StereoCalibrationTest, MissingFileThrows) {
+    EXPECT_THROW(StereoCalibration::load(testing::TempDir() + "no_such_calibration.yml"),
+                 std::runtime_error);
+}
+
+// Ideal rig for frames of size: focal length of one frame width, cameras
+// 0.1 apart, no distortion
+StereoCalibration idealRig(const cv::Size& size) {
+    const StereoCalibration::Camera camera{
+        cv::Matx33d(size.width, 0, size.width / 2.0, 0, size.width, size.height / 2.0, 0, 0, 1),
+        cv::Mat::zeros(1, 5, CV_64F)};
+    return StereoCalibration(size, camera, camera, cv::Matx33d::eye(), cv::Vec3d(-0.1, 0, 0));
+}
+
+TEST(StereoRectifierTest, RectifiesAndDownscalesInOneLookup) {
+    const StereoRectifier rectifier(idealRig(cv::Size(640, 480)), cv::Size(320, 240));
+    
+    // Blue ramps with x, green with y
+    cv::Mat raw(480, 640, CV_8UC3);
+    for (int y = 0; y < raw.rows; ++y) {
+        for (int x = 0; x < raw.cols; ++x) {
+            raw.at<cv::Vec3b>(y, x) = cv::Vec3b(x * 255 / 639, y * 255 / 479, 0);
+        }
+    }
+    
+    cv::Mat rectified;
+    rectifier.rectify(StereoEye::Left, raw, rectified);
+    
+    ASSERT_EQ(rectified.size(), cv::Size(320, 240));
+    const cv::Vec3b expected = raw.at<cv::Vec3b>(241, 321);
+    const cv::Vec3b centre = rectified.at<cv::Vec3b>(120, 160);
+    EXPECT_NEAR(centre[0], expected[0], 3);
+    EXPECT_NEAR(centre[1], expected[1], 3);
+    EXPECT_NEAR(rectifier.focalLength(), rectifier.calibration().focalLength() / 2, 1e-9);
+    
+    const cv::Rect box = rectifier.rectifyBox(StereoEye::Left, cv::Rect(300, 220, 40, 40));
+    EXPECT_NEAR(box.x + box.width / 2, 160, 1);
+    EXPECT_NEAR(box.y + box.height / 2, 120, 1);
+}
+
+TEST(StereoRectifierTest, CachesTablesOnDisk) {
+    const std::string path = testing::TempDir() + "stereo_rectification.bin";
+    std::remove(path.c_str());
+    const StereoCalibration calibration = idealRig(cv::Size(160, 120));
+    cv::Mat raw(120, 160, CV_8UC3);
+    cv::randu(raw, cv::Scalar::all(0), cv::Scalar::all(256));
+    
+    auto built = StereoRectifier::create(calibration, cv::Size(160, 120), path);
+    auto cached = StereoRectifier::create(calibration, cv::Size(160, 120), path);
+    std::ifstream file(path, std::ios::binary);
+    EXPECT_TRUE(file.good());
+    
+    cv::Mat fromBuilt, fromCached;
+    built->rectify(StereoEye::Right, raw, fromBuilt);
+    cached->rectify(StereoEye::Right, raw, fromCached);
+    EXPECT_EQ(cv::norm(fromBuilt, fromCached, cv::NORM_INF), 0.0);
+    
+    // Tables for another output size are rebuilt, not read
+    auto resized = StereoRectifier::create(calibration, cv::Size(80, 60), path);
+    cv::Mat small;
+    resized->rectify(StereoEye::Right, raw, small);
+    EXPECT_EQ(small.size(), cv::Size(80, 60));
+    std::remove(path.c_str());
+}
+
+TEST_F(ReplayFrameSourceTest, CaptureRectifiesPooledFrames) {
+    StereoCaptureSystem::CameraConfig config{
+        .deviceId = -1, .width = width, .height = height, .fps = 30, .cpuCore = 0
+    };
+    auto rectifier = std::make_shared<StereoRectifier>(idealRig(cv::Size(width, height)),
+                                                       cv::Size(width / 2, height / 2));
+    StereoCaptureSystem system(
+        std::make_unique<ReplayFrameSource>(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false)),
+        std::make_unique<ReplayFrameSource>(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false)),
+        config, config, rectifier);
+    
+    EXPECT_EQ(system.frameSize(true), cv::Size(width / 2, height / 2));
+    FramePool::Handle left, right;
+    ASSERT_TRUE(system.captureLeftFrame(left));
+    ASSERT_TRUE(system.captureLeftFrame(left));
+    ASSERT_TRUE(system.captureRightFrame(right));
+    EXPECT_EQ(left.frame().size(), cv::Size(width / 2, height / 2));
+    EXPECT_EQ(left.frame().at<cv::Vec3b>(height / 4, width / 4)[0], 1);
+    EXPECT_EQ(right.frame().at<cv::Vec3b>(height / 4, width / 4)[0], 0);
+    EXPECT_TRUE(system.updateMergedView(left.frame(), true));
+    
+    // Cameras the tables were not built for are rejected
+    StereoCaptureSystem::CameraConfig other = config;
+    other.width = 2 * width;
+    EXPECT_THROW(StereoCaptureSystem(
+        std::make_unique<ReplayFrameSource>(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false)),
+        std::make_unique<ReplayFrameSource>(makeConfig(ReplayFrameSource::Pacing::AsFastAsPossible, false)),
+        other, other, rectifier), std::invalid_argument);
+}
@@ -1,6 +1,15 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "detection/yolo_detector.hpp"
+#include "detection/async_detector.hpp"
+#include "detection/detector_pool.hpp"
+#include "detection/yolo_decoder.hpp"
+#include "detection/nms.hpp"
+#include "detection/resolution_controller.hpp"
+#include "detection/roi_inference.hpp"
+#include "processing/blob_kernel.hpp"
+#include <array>
+#include <thread>
 
 using namespace rt;
 using namespace testing;
@@ -111,17 +120,18 @@ TEST_F(YOLODetectorTest, ConfigValidation) {
 }
 
 TEST_F(YOLODetectorTest, ThreadSafetyTest) {
-    YOLODetector detector(config);
+    // A detector is single-threaded; each thread gets its own from the pool
+    const int numThreads = 4;
+    DetectorPool pool(config, numThreads);
     cv::Mat testImg = createTestImage();
     
     std::vector<std::thread> threads;
     std::atomic<int> successCount{0};
-    const int numThreads = 4;
     
     for (int i = 0; i < numThreads; ++i) {
-        threads.emplace_back([&detector, &testImg, &successCount]() {
+        threads.emplace_back([&pool, i, &testImg, &successCount]() {
             try {
-                auto results = detector.detect(testImg);
+                auto results = pool.forWorker(i).detect(testImg);
                 if (!results.empty()) {
                     successCount++;
                 }
@@ -138,6 +148,45 @@ TEST_F(YOLODetectorTest, ThreadSafetyTest) {
     EXPECT_EQ(successCount, numThreads);
 }
 
+TEST_F(YOLODetectorTest, PoolSharesModelAndLeasesRoundRobin) {
+    DetectorPool pool(config, 2);
+    ASSERT_EQ(pool.size(), 2u);
+    EXPECT_EQ(pool.model().use_count(), 3);  // The pool and both detectors
+    EXPECT_NE(&pool.forWorker(0), &pool.forWorker(1));
+    EXPECT_EQ(&pool.forWorker(2), &pool.forWorker(0));
+    
+    {
+        auto first = pool.tryAcquire();
+        auto second = pool.tryAcquire();
+        ASSERT_TRUE(first && second);
+        EXPECT_NE(&*first, &*second);
+        EXPECT_FALSE(pool.tryAcquire());  // Both in use
+        
+        EXPECT_FALSE(first->detect(createTestImage()).empty());
+    }
+    
+    EXPECT_TRUE(pool.tryAcquire());
+    EXPECT_THROW(DetectorPool(config, 0), std::invalid_argument);
+}
+
+TEST_F(YOLODetectorTest, InferenceThreadsConfinedToMask) {
+    const CpuMask before = currentCpuMask();
+    ASSERT_NE(before, 0u);
+    
+    // Lowest core this process may use
+    config.inferenceThreads = 4;
+    config.inferenceCpuMask = before & (~before + 1);
+    auto model = YoloModel::load(config.modelPath, config.configPath, config.classesPath);
+    YOLODetector detector(config, model);
+    
+    EXPECT_EQ(detector.getInferenceThreadCount(), 1);  // Capped to the mask
+    EXPECT_EQ(currentCpuMask(), before);               // Caller restored
+    EXPECT_FALSE(detector.detect(createTestImage()).empty());
+    
+    EXPECT_THROW(configureInferenceThreads(-1, 0), std::invalid_argument);
+    EXPECT_GT(configureInferenceThreads(0, 0), 0);
+}
+
 TEST_F(YOLODetectorTest, PreprocessingTest) {
     YOLODetector detector(config);
     
@@ -157,4 +206,516 @@ TEST_F(YOLODetectorTest, PreprocessingTest) {
             detector.detect(testImg);
         });
     }
-} 
\ No newline at end of file
+} 
+
+TEST_F(YOLODetectorTest, PreparedInputTensors) {
+    YOLODetector detector(config);
+    detector.reserveInputs(2);
+    ASSERT_EQ(detector.inputCount(), 2u);
+    
+    cv::Mat& tensor = detector.inputTensor(1);
+    EXPECT_EQ(tensor.dims, 4);
+    EXPECT_EQ(tensor.size[1], 3);
+    EXPECT_EQ(tensor.size[2], config.inputHeight);
+    EXPECT_EQ(tensor.size[3], config.inputWidth);
+    EXPECT_THROW(detector.inputTensor(2), std::out_of_range);
+    
+    // Fill the detector's own tensor in place and run it twice
+    BlobKernel kernel(cv::Size(config.inputWidth, config.inputHeight));
+    kernel.letterbox(createTestImage(), tensor.ptr<float>());
+    const uchar* storage = tensor.data;
+    
+    std::vector<YOLODetector::DetectionResult> results;
+    detector.detectPrepared(1, results);
+    EXPECT_FALSE(results.empty());
+    
+    detector.detectPrepared(1, results);
+    EXPECT_EQ(detector.inputTensor(1).data, storage);
+    for (const auto& det : results) {
+        EXPECT_GE(det.confidence, config.confThreshold);
+        EXPECT_GT(det.box.width, 0);
+    }
+    
+    const int wrongShape[] = {1, 3, config.inputHeight, config.inputWidth + 1};
+    EXPECT_THROW(detector.detectBlob(cv::Mat(4, wrongShape, CV_32F, cv::Scalar(0))),
+                 std::invalid_argument);
+}
+
+TEST_F(YOLODetectorTest, BatchedInferenceMatchesSingleImages) {
+    YOLODetector detector(config);
+    detector.reserveInputs(1, 2);
+    ASSERT_EQ(detector.inputBatchSize(), 2);
+    
+    BlobKernel kernel(cv::Size(config.inputWidth, config.inputHeight));
+    cv::Mat blank(416, 416, CV_8UC3, cv::Scalar(0, 0, 0));
+    kernel.letterbox(createTestImage(), detector.inputImage(0, 0));
+    kernel.letterbox(blank, detector.inputImage(0, 1));
+    
+    std::array<std::vector<YOLODetector::DetectionResult>, 2> batched;
+    detector.detectBatch(0, 2, batched.data());
+    
+    // A partial batch runs only the leading image
+    std::vector<YOLODetector::DetectionResult> single;
+    detector.detectBatch(0, 1, &single);
+    
+    ASSERT_EQ(batched[0].size(), single.size());
+    for (size_t i = 0; i < single.size(); ++i) {
+        EXPECT_EQ(batched[0][i].classId, single[i].classId);
+        EXPECT_EQ(batched[0][i].box, single[i].box);
+    }
+    EXPECT_THROW(detector.detectBatch(0, 3, batched.data()), std::out_of_range);
+}
+
+TEST_F(YOLODetectorTest, AsyncDetectionMatchesBlocking) {
+    YOLODetector detector(config);
+    detector.reserveInputs(2);
+    AsyncDetector async(detector, 128);
+    
+    BlobKernel kernel(cv::Size(config.inputWidth, config.inputHeight));
+    kernel.letterbox(createTestImage(), detector.inputImage(0, 0));
+    
+    std::vector<YOLODetector::DetectionResult> blocking;
+    detector.detectPrepared(0, blocking);
+    
+    std::vector<YOLODetector::DetectionResult> results;
+    EXPECT_FALSE(async.poll(&results));
+    ASSERT_TRUE(async.submit(0, 1));
+    EXPECT_FALSE(async.submit(1, 1));  // One request in flight at a time
+    EXPECT_FALSE(async.poll(&results));
+    
+    // The next input can be filled while the worker runs
+    std::thread worker([&async] { async.runPending(); });
+    kernel.letterbox(createTestImage(), detector.inputImage(1, 0));
+    worker.join();
+    
+    ASSERT_TRUE(async.ready());
+    ASSERT_TRUE(async.poll(&results));
+    EXPECT_FALSE(async.busy());
+    EXPECT_FALSE(async.runPending());
+    ASSERT_EQ(results.size(), blocking.size());
+    for (size_t i = 0; i < results.size(); ++i) {
+        EXPECT_EQ(results[i].classId, blocking[i].classId);
+        EXPECT_EQ(results[i].box, blocking[i].box);
+    }
+    
+    EXPECT_TRUE(async.submit(1, 1));
+    EXPECT_THROW(async.submit(2, 1), std::out_of_range);
+}
+
+TEST_F(YOLODetectorTest, PerSlotInputResolution) {
+    YOLODetector detector(config);
+    detector.reserveInputs(2);
+    EXPECT_EQ(detector.resolutionCount(), 1u);
+    
+    const std::vector<cv::Size> sizes{{320, 320}, {416, 416}, {512, 512}};
+    detector.reserveResolutions(sizes);
+    ASSERT_EQ(detector.resolutionCount(), 3u);
+    EXPECT_EQ(detector.resolution(2), cv::Size(512, 512));
+    
+    // Every level shares the slot's storage
+    const uchar* storage = detector.inputTensor(0).data;
+    detector.setInputResolution(0, 0);
+    EXPECT_EQ(detector.inputTensor(0).size[3], 320);
+    EXPECT_EQ(detector.inputTensor(0).data, storage);
+    EXPECT_EQ(detector.inputResolution(1), 0u);
+    
+    BlobKernel kernel(sizes[0]);
+    kernel.letterbox(createTestImage(), detector.inputImage(0, 0));
+    std::vector<YOLODetector::DetectionResult> results;
+    detector.detectPrepared(0, results);
+    for (const auto& det : results) {
+        EXPECT_LE(det.box.x + det.box.width, 320 + 1);
+    }
+    
+    EXPECT_THROW(detector.setInputResolution(0, 3), std::out_of_range);
+    EXPECT_THROW(detector.reserveResolutions({{416, 416}, {320, 320}}), std::invalid_argument);
+}
+
+TEST_F(YOLODetectorTest, WarmsEachResolutionAtItsOwnBatch) {
+    YOLODetector detector(config);
+    detector.reserveInputs(1, 4);
+    
+    EXPECT_EQ(detector.resolutionBatch(0), 4);  // Before any levels
+    
+    // A batched crop level below a single full-frame level
+    const std::vector<cv::Size> sizes{{160, 160}, {416, 416}};
+    detector.reserveResolutions(sizes, {4, 1});
+    ASSERT_EQ(detector.resolutionCount(), 2u);
+    EXPECT_EQ(detector.resolution(0), cv::Size(160, 160));
+    EXPECT_EQ(detector.resolutionBatch(0), 4);
+    EXPECT_EQ(detector.resolution(1), cv::Size(416, 416));
+    EXPECT_EQ(detector.resolutionBatch(1), 1);
+    EXPECT_THROW(detector.resolutionBatch(2), std::out_of_range);
+    
+    // Each level runs at its warmed batch, in the slot's shared storage
+    BlobKernel crops(sizes[0]);
+    detector.setInputResolution(0, 0);
+    for (int image = 0; image < detector.resolutionBatch(0); ++image) {
+        crops.letterbox(createTestImage(), detector.inputImage(0, image));
+    }
+    std::array<std::vector<YOLODetector::DetectionResult>, 4> batched;
+    detector.detectBatch(0, detector.resolutionBatch(0), batched.data());
+    for (const auto& image : batched) {
+        for (const auto& det : image) {
+            EXPECT_LE(det.box.x + det.box.width, 160 + 1);
+        }
+    }
+    
+    BlobKernel full(sizes[1]);
+    detector.setInputResolution(0, 1);
+    full.letterbox(createTestImage(), detector.inputImage(0, 0));
+    std::vector<YOLODetector::DetectionResult> results;
+    detector.detectBatch(0, detector.resolutionBatch(1), &results);
+    
+    // Without batches every level runs the reserved batch
+    detector.reserveResolutions(sizes);
+    EXPECT_EQ(detector.resolutionBatch(0), 4);
+    EXPECT_EQ(detector.resolutionBatch(1), 4);
+    
+    EXPECT_THROW(detector.reserveResolutions(sizes, {4}), std::invalid_argument);
+    EXPECT_THROW(detector.reserveResolutions(sizes, {5, 1}), std::invalid_argument);
+    EXPECT_THROW(detector.reserveResolutions(sizes, {0, 1}), std::invalid_argument);
+}
+
+TEST(ResolutionControllerTest, StepsDownUnderLoadAndBackUpWhenIdle) {
+    using std::chrono::milliseconds;
+    const std::vector<cv::Size> sizes{{320, 320}, {416, 416}, {512, 512}};
+    ResolutionController::Config config{milliseconds(100)};
+    config.upHoldCycles = 3;
+    config.smoothing = 1.0;  // React to every sample
+    ResolutionController controller(config, sizes);
+    EXPECT_EQ(controller.level(), 2u);
+    
+    // 120 ms at 512 predicts ~79 ms at 416, which fits
+    EXPECT_EQ(controller.update(milliseconds(120), 2), 1u);
+    EXPECT_GT(controller.slack(), 0.0);
+    
+    // A miss that far over budget drops to the smallest size
+    EXPECT_EQ(controller.update(milliseconds(200), 1), 0u);
+    
+    // Idle: climbs one level per hold period
+    for (int i = 0; i < 2; ++i) {
+        EXPECT_EQ(controller.update(milliseconds(10), 0), 0u);
+    }
+    EXPECT_EQ(controller.update(milliseconds(10), 0), 1u);
+    for (int i = 0; i < 3; ++i) {
+        controller.update(milliseconds(15), 1);
+    }
+    EXPECT_EQ(controller.level(), 2u);
+    
+    EXPECT_THROW(ResolutionController(config, {}), std::invalid_argument);
+}
+
+TEST(ResolutionControllerTest, ScalesSamplesByTheLevelTheyRanAt) {
+    using std::chrono::milliseconds;
+    const std::vector<cv::Size> sizes{{320, 320}, {640, 640}};
+    ResolutionController::Config config{milliseconds(100)};
+    config.smoothing = 1.0;
+    ResolutionController controller(config, sizes);
+    
+    // An input queued at 320 finishes after the switch to 640 was made;
+    // 60 ms at 320 predicts 240 ms at 640, so it must not count as 640
+    EXPECT_EQ(controller.update(milliseconds(60), 0), 0u);
+    EXPECT_EQ(controller.predictedCost(1), milliseconds(240));
+    EXPECT_THROW(controller.update(milliseconds(60), 2), std::out_of_range);
+}
+
+class YoloDecoderTest : public Test {
+protected:
+    static constexpr int kClasses = 80;
+    static constexpr int kCols = 5 + kClasses;
+    
+    void SetUp() override {
+        // 37 rows so the SIMD path also has a scalar tail
+        output = cv::Mat::zeros(37, kCols, CV_32F);
+        candidates.reserve(64);
+    }
+    
+    void setRow(int row, float objectness, int classId, float score) {
+        float* data = output.ptr<float>(row);
+        data[0] = 0.5f;   // centre x
+        data[1] = 0.25f;  // centre y
+        data[2] = 0.1f;   // width
+        data[3] = 0.2f;   // height
+        data[4] = objectness;
+        data[5 + classId] = score;
+    }
+    
+    YoloOutputView view() const {
+        return {output.ptr<float>(), output.rows, output.cols};
+    }
+    
+    cv::Mat output;
+    CandidateBuffer candidates;
+};
+
+TEST_F(YoloDecoderTest, KeepsOnlyConfidentRows) {
+    setRow(3, 0.9f, 17, 0.8f);
+    setRow(12, 0.9f, 2, 0.3f);   // Objectness passes, class score does not
+    setRow(20, 0.4f, 5, 0.4f);   // Rejected on objectness
+    setRow(36, 0.95f, 79, 0.9f); // Tail row
+    
+    decodeYoloOutput(view(), 0.5f, cv::Size(416, 416), candidates);
+    
+    ASSERT_EQ(candidates.size(), 2u);
+    EXPECT_EQ(candidates.classId[0], 17);
+    EXPECT_FLOAT_EQ(candidates.score[0], 0.8f);
+    EXPECT_EQ(candidates.classId[1], 79);
+    EXPECT_FLOAT_EQ(candidates.x0[0], 416 * 0.45f);
+    EXPECT_FLOAT_EQ(candidates.y1[0], 416 * 0.35f);
+    EXPECT_EQ(candidates.rect(0), cv::Rect(187, 62, 41, 83));
+}
+
+TEST_F(YoloDecoderTest, SimdMatchesScalar) {
+    cv::randu(output, cv::Scalar(0.0), cv::Scalar(1.0));
+    
+    CandidateBuffer scalar;
+    scalar.reserve(64);
+    decodeYoloOutput(view(), 0.9f, cv::Size(416, 416), scalar, SimdLevel::Scalar);
+    decodeYoloOutput(view(), 0.9f, cv::Size(416, 416), candidates, SimdLevel::AVX2);
+    
+    ASSERT_GT(scalar.size(), 0u);
+    EXPECT_EQ(candidates.classId, scalar.classId);
+    EXPECT_EQ(candidates.score, scalar.score);
+    EXPECT_EQ(candidates.x0, scalar.x0);
+}
+
+TEST_F(YoloDecoderTest, CountsOverflowInsteadOfGrowing) {
+    for (int row = 0; row < output.rows; ++row) {
+        setRow(row, 0.9f, row % kClasses, 0.8f);
+    }
+    
+    CandidateBuffer small;
+    small.reserve(8);
+    const float* storage = small.score.data();
+    decodeYoloOutput(view(), 0.5f, cv::Size(416, 416), small);
+    
+    EXPECT_EQ(small.size(), 8u);
+    EXPECT_EQ(small.overflows, 29u);
+    EXPECT_EQ(small.score.data(), storage);
+}
+
+class NmsEngineTest : public Test {
+protected:
+    void SetUp() override {
+        candidates.reserve(64);
+        nms.reserve(64);
+        keep.reserve(64);
+    }
+    
+    void add(float x, float y, float size, float score, int classId) {
+        candidates.push(x, y, x + size, y + size, score, classId);
+    }
+    
+    CandidateBuffer candidates;
+    NmsEngine nms;
+    std::vector<int> keep;
+};
+
+TEST_F(NmsEngineTest, SuppressesOverlapsWithinClassOnly) {
+    add(10, 10, 100, 0.7f, 0);
+    add(12, 12, 100, 0.9f, 0);   // Overlaps box 0, higher score
+    add(11, 11, 100, 0.8f, 1);   // Same place, other class
+    add(300, 300, 50, 0.6f, 0);  // Separate
+    
+    nms.run(candidates, 0.5f, 0, keep);
+    
+    EXPECT_THAT(keep, ElementsAre(1, 2, 3));
+}
+
+TEST_F(NmsEngineTest, TopKKeepsBestBoxes) {
+    for (int i = 0; i < 20; ++i) {
+        add(60.0f * i, 0, 50, 0.5f + 0.01f * i, i % 3);
+    }
+    
+    nms.run(candidates, 0.5f, 4, keep);
+    
+    EXPECT_THAT(keep, ElementsAre(19, 18, 17, 16));
+}
+
+TEST_F(NmsEngineTest, SimdMatchesScalar) {
+    cv::RNG rng(7);
+    for (int i = 0; i < 60; ++i) {
+        add(rng.uniform(0.0f, 200.0f), rng.uniform(0.0f, 200.0f), rng.uniform(20.0f, 80.0f),
+            rng.uniform(0.5f, 1.0f), rng.uniform(0, 2));
+    }
+    
+    std::vector<int> scalar;
+    NmsEngine(SimdLevel::Scalar).run(candidates, 0.45f, 0, scalar);
+    NmsEngine(SimdLevel::AVX2).run(candidates, 0.45f, 0, keep);
+    
+    ASSERT_FALSE(scalar.empty());
+    EXPECT_EQ(keep, scalar);
+}
+
+TEST_F(NmsEngineTest, DoesNotReallocateAfterReserve) {
+    for (int i = 0; i < 40; ++i) {
+        add(5.0f * i, 0, 50, 0.9f - 0.01f * i, 0);
+    }
+    const int* storage = keep.data();
+    
+    nms.run(candidates, 0.3f, 0, keep);
+    nms.run(candidates, 0.3f, 0, keep);
+    
+    EXPECT_FALSE(keep.empty());
+    EXPECT_EQ(keep.data(), storage);
+}
+
+TEST(RoiPlannerTest, CropsKnownObjectsBetweenFullFramePasses) {
+    RoiPlanner::Config config;
+    config.fullFrameInterval = 4;
+    RoiPlanner planner(config);
+    const std::vector<cv::Rect> known{cv::Rect(100, 100, 40, 80), cv::Rect(500, 300, 60, 60)};
+    std::vector<cv::Rect> regions;
+    
+    // Starts by looking at everything
+    EXPECT_FALSE(planner.plan(known, cv::Size(640, 480), regions));
+    for (int frame = 0; frame < 3; ++frame) {
+        ASSERT_TRUE(planner.plan(known, cv::Size(640, 480), regions));
+        ASSERT_EQ(regions.size(), 2u);
+        for (const cv::Rect& region : regions) {
+            EXPECT_EQ(region & cv::Rect(0, 0, 640, 480), region);
+        }
+        EXPECT_EQ(regions[0] & known[0], known[0]);
+        EXPECT_EQ(regions[1] & known[1], known[1]);
+    }
+    EXPECT_FALSE(planner.plan(known, cv::Size(640, 480), regions));
+    EXPECT_TRUE(regions.empty());
+}
+
+TEST(RoiPlannerTest, MergesOverlappingCropsAndFallsBackWhenCropsDoNotPay) {
+    RoiPlanner planner(RoiPlanner::Config{});
+    std::vector<cv::Rect> regions;
+    EXPECT_FALSE(planner.plan({cv::Rect(0, 0, 10, 10)}, cv::Size(640, 480), regions));
+    
+    ASSERT_TRUE(planner.plan({cv::Rect(100, 100, 40, 40), cv::Rect(130, 110, 40, 40)},
+                             cv::Size(640, 480), regions));
+    EXPECT_EQ(regions.size(), 1u);
+    
+    // Nothing known, too many crops, or too much of the frame
+    EXPECT_FALSE(planner.plan({}, cv::Size(640, 480), regions));
+    EXPECT_FALSE(planner.plan({cv::Rect(0, 0, 20, 20), cv::Rect(200, 0, 20, 20),
+                               cv::Rect(400, 0, 20, 20), cv::Rect(0, 300, 20, 20)},
+                              cv::Size(640, 480), regions));
+    EXPECT_FALSE(planner.plan({cv::Rect(50, 50, 400, 300)}, cv::Size(640, 480), regions));
+}
+
+TEST(RegionMergerTest, MapsCropsToFrameAndDropsDuplicates) {
+    std::array<RegionInput, 2> regions;
+    regions[0].roi = cv::Rect(0, 0, 200, 200);
+    regions[1].roi = cv::Rect(100, 0, 200, 200);
+    regions[1].image = 1;
+    for (auto& region : regions) {
+        region.transform = LetterboxTransform::compute(region.roi.size(), cv::Size(320, 320));
+    }
+    
+    // The same object seen by both crops, plus one only the second sees
+    std::array<std::vector<YOLODetector::DetectionResult>, 2> perImage;
+    perImage[0] = {{0, 0.9f, cv::Rect(240, 160, 40, 80), "person"}};
+    perImage[1] = {{0, 0.7f, cv::Rect(80, 160, 40, 80), "person"},
+                   {2, 0.6f, cv::Rect(240, 0, 32, 32), "car"}};
+    
+    RegionMerger merger(16);
+    std::vector<YOLODetector::DetectionResult> results;
+    merger.merge(perImage.data(), regions.data(), 2, 0.45f, results);
+    
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].box, cv::Rect(150, 100, 25, 50));
+    EXPECT_FLOAT_EQ(results[0].confidence, 0.9f);
+    EXPECT_EQ(results[1].className, "car");
+    EXPECT_EQ(results[1].box, cv::Rect(250, 0, 20, 20));
+}
+
+TEST(RegionMergerTest, CountsBoxesDroppedForCapacity) {
+    std::array<RegionInput, 2> regions;
+    regions[0].roi = cv::Rect(0, 0, 200, 200);
+    regions[1].roi = cv::Rect(200, 0, 200, 200);
+    regions[1].image = 1;
+    for (auto& region : regions) {
+        region.transform = LetterboxTransform::compute(region.roi.size(), cv::Size(320, 320));
+    }
+    
+    std::array<std::vector<YOLODetector::DetectionResult>, 2> perImage;
+    perImage[0] = {{0, 0.9f, cv::Rect(0, 0, 40, 40), "person"},
+                   {0, 0.8f, cv::Rect(160, 160, 40, 40), "person"}};
+    perImage[1] = {{2, 0.6f, cv::Rect(0, 0, 40, 40), "car"}};
+    
+    RegionMerger merger(2);
+    std::vector<YOLODetector::DetectionResult> results;
+    merger.merge(perImage.data(), regions.data(), 2, 0.45f, results);
+    merger.merge(perImage.data(), regions.data(), 2, 0.45f, results);
+    
+    EXPECT_EQ(results.size(), 2u);
+    EXPECT_EQ(merger.droppedCandidates(), 2u);
+}
+
+TEST(RegionMergerTest, SplitsMosaicDetectionsByCell) {
+    std::vector<cv::Rect> cells;
+    planMosaic(cv::Size(320, 320), 2, cells);
+    ASSERT_THAT(cells, ElementsAre(cv::Rect(0, 0, 160, 320), cv::Rect(160, 0, 160, 320)));
+    
+    // Two crops letterboxed side by side into one image
+    std::array<RegionInput, 2> regions;
+    regions[0].roi = cv::Rect(0, 0, 200, 200);
+    regions[1].roi = cv::Rect(300, 0, 200, 200);
+    for (int i = 0; i < 2; ++i) {
+        regions[i].cell = cells[i];
+        regions[i].transform = LetterboxTransform::compute(regions[i].roi.size(), cells[i].size());
+        regions[i].transform.padX += cells[i].x;
+    }
+    
+    std::vector<YOLODetector::DetectionResult> perImage = {
+        {0, 0.9f, cv::Rect(40, 120, 40, 40), "person"},
+        {2, 0.6f, cv::Rect(200, 80, 40, 80), "car"}};
+    
+    RegionMerger merger(16);
+    std::vector<YOLODetector::DetectionResult> results;
+    merger.merge(&perImage, regions.data(), 2, 0.45f, results);
+    
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].box, cv::Rect(50, 50, 50, 50));
+    EXPECT_EQ(results[1].box, cv::Rect(350, 0, 50, 100));
+    
+    // One crop alone keeps only the detections centred in its cell
+    merger.merge(&perImage, regions.data() + 1, 1, 0.45f, results);
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].className, "car");
+}
+
+TEST(RegionMergerTest, PlansMosaicCellsCoveringTheInput) {
+    std::vector<cv::Rect> cells;
+    planMosaic(cv::Size(416, 416), 3, cells);
+    
+    // Two cells on top, the last one spanning the bottom row
+    EXPECT_THAT(cells, ElementsAre(cv::Rect(0, 0, 208, 208), cv::Rect(208, 0, 208, 208),
+                                   cv::Rect(0, 208, 416, 208)));
+    
+    planMosaic(cv::Size(416, 416), 1, cells);
+    EXPECT_THAT(cells, ElementsAre(cv::Rect(0, 0, 416, 416)));
+    EXPECT_THROW(planMosaic(cv::Size(416, 416), 0, cells), std::invalid_argument);
+}
+
+TEST(TilePlannerTest, CoversFrameWithOverlappingNativeScaleTiles) {
+    TilePlanner planner(TilePlanner::Config{});
+    std::vector<cv::Rect> tiles;
+    
+    planner.plan(cv::Size(640, 480), cv::Size(416, 416), tiles);
+    
+    EXPECT_THAT(tiles, ElementsAre(cv::Rect(0, 0, 416, 416), cv::Rect(224, 0, 416, 416),
+                                   cv::Rect(0, 64, 416, 416), cv::Rect(224, 64, 416, 416)));
+}
+
+TEST(TilePlannerTest, GrowsTilesWhenOverTileBudget) {
+    TilePlanner::Config config;
+    config.maxTiles = 2;
+    TilePlanner planner(config);
+    std::vector<cv::Rect> tiles;
+    
+    planner.plan(cv::Size(1280, 480), cv::Size(320, 320), tiles);
+    
+    EXPECT_THAT(tiles, ElementsAre(cv::Rect(0, 0, 672, 480), cv::Rect(608, 0, 672, 480)));
+    
+    // A frame smaller than a tile is a single tile
+    planner.plan(cv::Size(200, 100), cv::Size(320, 320), tiles);
+    EXPECT_THAT(tiles, ElementsAre(cv::Rect(0, 0, 200, 100)));
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "utils/spsc_queue.hpp"
+#include "utils/triple_buffer.hpp"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace rt;
+using namespace testing;
+
+class SpscQueueTest : public Test {
+protected:
+    using Queue = SpscQueue<std::vector<int>, 4>;
+
+    void SetUp() override {
+        queue = std::make_unique<Queue>([](std::vector<int>& slot) {
+            slot.reserve(16);
+        });
+    }
+
+    std::unique_ptr<Queue> queue;
+};
+
+TEST_F(SpscQueueTest, EmptyOnConstruction) {
+    EXPECT_TRUE(queue->empty());
+    EXPECT_EQ(queue->front(), nullptr);
+    EXPECT_EQ(Queue::capacity(), 4u);
+}
+
+TEST_F(SpscQueueTest, FifoOrder) {
+    for (int i = 0; i < 3; ++i) {
+        auto* slot = queue->beginWrite();
+        ASSERT_NE(slot, nullptr);
+        slot->assign(1, i);
+        queue->commitWrite();
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        auto* slot = queue->front();
+        ASSERT_NE(slot, nullptr);
+        EXPECT_EQ(slot->front(), i);
+        queue->pop();
+    }
+    EXPECT_TRUE(queue->empty());
+}
+
+TEST_F(SpscQueueTest, SlotsAreReusedWithoutReallocation) {
+    std::vector<const int*> storage;
+    for (size_t i = 0; i < Queue::capacity(); ++i) {
+        auto* slot = queue->beginWrite();
+        slot->assign(4, 0);
+        storage.push_back(slot->data());
+        queue->commitWrite();
+        queue->pop();
+    }
+
+    // Second lap hands out the same pre-reserved buffers
+    for (size_t i = 0; i < Queue::capacity(); ++i) {
+        auto* slot = queue->beginWrite();
+        slot->assign(8, 1);
+        EXPECT_EQ(slot->data(), storage[i]);
+        queue->commitWrite();
+        queue->pop();
+    }
+}
+
+TEST_F(SpscQueueTest, OverrunWhenFull) {
+    for (size_t i = 0; i < Queue::capacity(); ++i) {
+        ASSERT_NE(queue->beginWrite(), nullptr);
+        queue->commitWrite();
+    }
+
+    EXPECT_EQ(queue->beginWrite(), nullptr);
+    EXPECT_EQ(queue->overruns(), 1u);
+}
+
+TEST_F(SpscQueueTest, DropStaleKeepsNewest) {
+    for (int i = 0; i < 3; ++i) {
+        queue->beginWrite()->assign(1, i);
+        queue->commitWrite();
+    }
+
+    queue->dropStale();
+    ASSERT_EQ(queue->size(), 1u);
+    EXPECT_EQ(queue->front()->front(), 2);
+}
+
+TEST_F(SpscQueueTest, ConcurrentProducerConsumer) {
+    const int numItems = 100000;
+
+    std::thread producer([this, numItems]() {
+        for (int i = 0; i < numItems; ++i) {
+            std::vector<int>* slot;
+            while ((slot = queue->beginWrite()) == nullptr) {
+                std::this_thread::yield();
+            }
+            slot->assign(1, i);
+            queue->commitWrite();
+        }
+    });
+
+    // Drain everything before asserting, so the producer always finishes
+    int expected = 0;
+    int outOfOrder = 0;
+    while (expected < numItems) {
+        if (auto* slot = queue->front()) {
+            outOfOrder += slot->front() != expected;
+            queue->pop();
+            ++expected;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    EXPECT_EQ(outOfOrder, 0);
+    EXPECT_TRUE(queue->empty());
+}
+
+TEST(TripleBufferTest, ReaderSeesOnlyPublishedValues) {
+    TripleBuffer<int> buffer([](int& value) { value = 0; });
+
+    buffer.back() = 1;
+    EXPECT_FALSE(buffer.update());
+    EXPECT_EQ(buffer.front(), 0);
+
+    buffer.publish();
+    EXPECT_TRUE(buffer.update());
+    EXPECT_EQ(buffer.front(), 1);
+    EXPECT_FALSE(buffer.update());
+}
+
+TEST(TripleBufferTest, ReaderGetsNewestValue) {
+    TripleBuffer<int> buffer([](int& value) { value = 0; });
+
+    for (int i = 1; i <= 5; ++i) {
+        buffer.back() = i;
+        buffer.publish();
+    }
+
+    EXPECT_TRUE(buffer.update());
+    EXPECT_EQ(buffer.front(), 5);
+}
+
+TEST(TripleBufferTest, WriterNeverTouchesFront) {
+    TripleBuffer<int> buffer([](int& value) { value = 0; });
+
+    buffer.back() = 1;
+    buffer.publish();
+    buffer.update();
+    const int* front = &buffer.front();
+
+    for (int i = 2; i < 10; ++i) {
+        EXPECT_NE(&buffer.back(), front);
+        buffer.back() = i;
+        buffer.publish();
+    }
+    EXPECT_EQ(*front, 1);
+}
+
+TEST(TripleBufferTest, ConcurrentValuesAreComplete) {
+    // Both halves are written together; a torn read would see them differ
+    TripleBuffer<std::array<int, 2>> buffer([](std::array<int, 2>& value) {
+        value = {0, 0};
+    });
+    const int numUpdates = 100000;
+
+    std::thread writer([&buffer, numUpdates]() {
+        for (int i = 1; i <= numUpdates; ++i) {
+            buffer.back() = {i, i};
+            buffer.publish();
+        }
+    });
+
+    // Read up to the final value before asserting, so the writer is joined
+    int last = 0;
+    int torn = 0;
+    int stale = 0;
+    while (last < numUpdates) {
+        if (buffer.update()) {
+            const auto& value = buffer.front();
+            torn += value[0] != value[1];
+            stale += value[0] < last;
+            last = std::max(last, value[0]);
+        }
+    }
+
+    writer.join();
+    EXPECT_EQ(torn, 0);
+    EXPECT_EQ(stale, 0);
+}
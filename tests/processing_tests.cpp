@@ -0,0 +1,371 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "processing/letterbox.hpp"
+#include "processing/blob_kernel.hpp"
+#include "processing/motion_gate.hpp"
+#include "processing/depth_estimator.hpp"
+
+using namespace rt;
+using namespace testing;
+
+class LetterboxTest : public Test {
+protected:
+    void SetUp() override {
+        // 640x480 camera frame into a 416x416 network input
+        source = cv::Mat(480, 640, CV_8UC3, cv::Scalar(10, 20, 30));
+        input = cv::Mat(416, 416, CV_8UC3);
+    }
+    
+    cv::Mat source;
+    cv::Mat input;
+};
+
+TEST_F(LetterboxTest, PreservesAspectRatio) {
+    auto transform = LetterboxTransform::compute(source.size(), input.size());
+    
+    EXPECT_FLOAT_EQ(transform.scale, 0.65f);
+    EXPECT_EQ(transform.padX, 0);
+    EXPECT_EQ(transform.padY, 52);  // (416 - 312) / 2
+    EXPECT_EQ(transform.contentRect(), cv::Rect(0, 52, 416, 312));
+}
+
+TEST_F(LetterboxTest, PadsBordersAndKeepsContent) {
+    const uchar* before = input.data;
+    letterbox(source, input);
+    
+    EXPECT_EQ(input.data, before);  // Written in place
+    EXPECT_EQ(input.at<cv::Vec3b>(10, 200)[0], 127);   // Top border
+    EXPECT_EQ(input.at<cv::Vec3b>(410, 200)[0], 127);  // Bottom border
+    EXPECT_EQ(input.at<cv::Vec3b>(208, 208)[0], 10);   // Image content
+    EXPECT_EQ(input.at<cv::Vec3b>(208, 208)[2], 30);
+}
+
+TEST_F(LetterboxTest, MapsBoxesBackToSourcePixels) {
+    auto transform = LetterboxTransform::compute(source.size(), input.size());
+    
+    // A box covering the left half of the content area
+    cv::Rect box = transform.toSource(cv::Rect(0, 52, 208, 312));
+    EXPECT_EQ(box, cv::Rect(0, 0, 320, 480));
+    
+    // Boxes reaching into the padding are clamped to the image
+    cv::Rect clamped = transform.toSource(cv::Rect(-10, 0, 100, 416));
+    EXPECT_EQ(clamped.x, 0);
+    EXPECT_EQ(clamped.y, 0);
+    EXPECT_EQ(clamped.height, 480);
+}
+
+TEST_F(LetterboxTest, RejectsMismatchedDestination) {
+    cv::Mat gray(416, 416, CV_8UC1);
+    EXPECT_THROW(letterbox(source, gray), std::invalid_argument);
+}
+
+class BlobKernelTest : public Test {
+protected:
+    void SetUp() override {
+        source = cv::Mat(480, 640, CV_8UC3, cv::Scalar(10, 20, 30));
+        blob.assign(3 * 416 * 416, -1.0f);
+    }
+    
+    float at(int plane, int y, int x) const {
+        return blob[(plane * 416 + y) * 416 + x];
+    }
+    
+    cv::Mat source;
+    std::vector<float> blob;
+};
+
+TEST_F(BlobKernelTest, WritesPlanarRgbInZeroToOne) {
+    BlobKernel kernel(cv::Size(416, 416));
+    auto transform = kernel.letterbox(source, blob.data());
+    
+    EXPECT_EQ(transform.contentRect(), cv::Rect(0, 52, 416, 312));
+    EXPECT_NEAR(at(0, 208, 208), 30 / 255.0f, 1e-6);  // R plane holds BGR red
+    EXPECT_NEAR(at(1, 208, 208), 20 / 255.0f, 1e-6);
+    EXPECT_NEAR(at(2, 208, 208), 10 / 255.0f, 1e-6);
+    EXPECT_NEAR(at(0, 10, 200), 127 / 255.0f, 1e-6);   // Top border
+    EXPECT_NEAR(at(2, 410, 200), 127 / 255.0f, 1e-6);  // Bottom border
+    
+    for (float value : blob) {
+        ASSERT_GE(value, 0.0f);  // Every element written
+    }
+}
+
+TEST_F(BlobKernelTest, LetterboxesIntoOneCellOnly) {
+    // The right half of the input, as one crop of a two-crop mosaic
+    BlobKernel kernel(cv::Size(416, 416));
+    const cv::Rect cell(208, 0, 208, 416);
+    auto transform = kernel.letterbox(source, blob.data(), cell);
+    
+    EXPECT_EQ(transform.contentRect(), cv::Rect(208, 130, 208, 156));
+    EXPECT_EQ(transform.toSource(cv::Rect(208, 130, 104, 78)), cv::Rect(0, 0, 320, 240));
+    EXPECT_NEAR(at(0, 208, 300), 30 / 255.0f, 1e-6);
+    EXPECT_NEAR(at(1, 10, 300), 127 / 255.0f, 1e-6);  // The cell's top border
+    EXPECT_EQ(at(0, 208, 100), -1.0f);                // Outside the cell
+    
+    EXPECT_THROW(kernel.letterbox(source, blob.data(), cv::Rect(300, 0, 208, 416)),
+                 std::invalid_argument);
+}
+
+TEST_F(BlobKernelTest, InterpolatesBetweenPixels) {
+    // Doubling a two-pixel gradient puts the inner samples a quarter of the way
+    cv::Mat ramp(1, 2, CV_8UC3);
+    ramp.at<cv::Vec3b>(0, 0) = cv::Vec3b(0, 0, 0);
+    ramp.at<cv::Vec3b>(0, 1) = cv::Vec3b(0, 0, 200);
+    
+    BlobKernel kernel(cv::Size(4, 1));
+    std::vector<float> out(3 * 4);
+    kernel.resize(ramp, out.data(), cv::Rect(0, 0, 4, 1));
+    
+    EXPECT_NEAR(out[0] * 255, 0, 1e-4);
+    EXPECT_NEAR(out[1] * 255, 50, 1e-4);
+    EXPECT_NEAR(out[2] * 255, 150, 1e-4);
+    EXPECT_NEAR(out[3] * 255, 200, 1e-4);
+}
+
+TEST_F(BlobKernelTest, SimdMatchesScalar) {
+    cv::Mat bgr(480, 640, CV_8UC3);
+    cv::randu(bgr, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::Mat yuyv(480, 640, CV_8UC2);
+    cv::randu(yuyv, cv::Scalar::all(0), cv::Scalar::all(256));
+    
+    // BGR and packed YUYV, the latter also cropped mid pixel pair
+    for (const cv::Mat& noise : {bgr, yuyv, yuyv(cv::Rect(101, 37, 300, 200))}) {
+        BlobKernel scalar(cv::Size(416, 416), SimdLevel::Scalar);
+        std::vector<float> expected(blob.size());
+        scalar.letterbox(noise, expected.data());
+        
+        for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2}) {
+            BlobKernel kernel(cv::Size(416, 416), level);
+            kernel.letterbox(noise, blob.data());
+            for (size_t i = 0; i < blob.size(); ++i) {
+                ASSERT_NEAR(blob[i], expected[i], 1e-5)
+                    << toString(kernel.simdLevel()) << " type " << noise.type() << " at " << i;
+            }
+        }
+    }
+}
+
+TEST_F(BlobKernelTest, ConvertsPackedYuyvWhileSampling) {
+    cv::Mat yuyv(480, 640, CV_8UC2);
+    cv::randu(yuyv, cv::Scalar::all(0), cv::Scalar::all(256));
+    cv::Mat bgr;
+    cv::cvtColor(yuyv, bgr, cv::COLOR_YUV2BGR_YUY2);
+    
+    // Whole frames, and crops that start in the middle of a pixel pair
+    for (const cv::Rect& crop : {cv::Rect(0, 0, 640, 480), cv::Rect(101, 37, 300, 200)}) {
+        BlobKernel kernel(cv::Size(416, 416));
+        std::vector<float> expected(blob.size());
+        kernel.letterbox(bgr(crop), expected.data());
+        kernel.letterbox(yuyv(crop), blob.data());
+        for (size_t i = 0; i < blob.size(); ++i) {
+            ASSERT_NEAR(blob[i], expected[i], 1.0f / 255) << crop << " at " << i;
+        }
+    }
+}
+
+TEST_F(BlobKernelTest, RejectsAreaOutsideInput) {
+    BlobKernel kernel(cv::Size(416, 416));
+    EXPECT_THROW(kernel.resize(source, blob.data(), cv::Rect(300, 0, 208, 416)),
+                 std::invalid_argument);
+}
+
+class MotionGateTest : public Test {
+protected:
+    void SetUp() override {
+        cv::randu(scene, cv::Scalar::all(0), cv::Scalar::all(256));
+    }
+    
+    cv::Mat scene{480, 640, CV_8UC3};
+};
+
+TEST_F(MotionGateTest, FirstFrameAlwaysPasses) {
+    MotionGate gate({});
+    EXPECT_TRUE(gate.check(scene));
+    EXPECT_EQ(gate.changedRegion(), cv::Rect(0, 0, 640, 480));
+}
+
+TEST_F(MotionGateTest, SkipsStaticSceneAndFindsChangedRegion) {
+    MotionGate gate({});
+    ASSERT_TRUE(gate.check(scene));
+    gate.accept();
+    
+    EXPECT_FALSE(gate.check(scene.clone()));
+    EXPECT_TRUE(gate.changedRegion().empty());
+    gate.skip();
+    
+    // Something appears in one corner; the region covers it in 32px cells
+    cv::Mat moved = scene.clone();
+    cv::rectangle(moved, cv::Rect(400, 300, 60, 40), cv::Scalar(255, 255, 255), cv::FILLED);
+    ASSERT_TRUE(gate.check(moved));
+    EXPECT_EQ(gate.changedRegion(), cv::Rect(384, 288, 96, 64));
+    
+    EXPECT_EQ(gate.stats().frames, 3u);
+    EXPECT_EQ(gate.stats().skipped, 1u);
+}
+
+TEST_F(MotionGateTest, IgnoresSensorNoise) {
+    MotionGate gate({});
+    gate.check(scene);
+    gate.accept();
+    
+    cv::Mat noise(scene.size(), CV_8UC3);
+    cv::randu(noise, cv::Scalar::all(0), cv::Scalar::all(8));
+    EXPECT_FALSE(gate.check(scene + noise));
+}
+
+TEST_F(MotionGateTest, ForcesDetectionAfterSkipLimit) {
+    MotionGate::Config config;
+    config.maxSkipped = 2;
+    MotionGate gate(config);
+    gate.check(scene);
+    gate.accept();
+    
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_FALSE(gate.check(scene));
+        gate.skip();
+    }
+    EXPECT_TRUE(gate.check(scene));
+    EXPECT_TRUE(gate.changedRegion().empty());
+}
+
+TEST_F(MotionGateTest, ReadsLumaOfPackedFrames) {
+    cv::Mat yuyv(480, 640, CV_8UC2);
+    cv::randu(yuyv, cv::Scalar::all(0), cv::Scalar::all(256));
+    MotionGate gate({});
+    ASSERT_TRUE(gate.check(yuyv));
+    gate.accept();
+    EXPECT_FALSE(gate.check(yuyv.clone()));
+    
+    cv::Mat moved = yuyv.clone();
+    moved(cv::Rect(400, 300, 60, 40)).setTo(cv::Scalar(255, 128));
+    ASSERT_TRUE(gate.check(moved));
+    EXPECT_EQ(gate.changedRegion(), cv::Rect(384, 288, 96, 64));
+}
+
+TEST_F(MotionGateTest, SimdMatchesScalar) {
+    cv::Mat changed = scene.clone();
+    cv::randu(changed(cv::Rect(100, 100, 200, 150)), cv::Scalar::all(0), cv::Scalar::all(256));
+    
+    MotionGate scalar({}, SimdLevel::Scalar);
+    scalar.check(scene);
+    scalar.accept();
+    scalar.check(changed);
+    
+    for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2}) {
+        MotionGate gate({}, level);
+        gate.check(scene);
+        gate.accept();
+        gate.check(changed);
+        EXPECT_EQ(gate.changedRegion(), scalar.changedRegion()) << toString(gate.simdLevel());
+    }
+}
+
+class DepthEstimatorTest : public Test {
+protected:
+    // Ideal rig: 500px focal length, cameras 0.1 apart, no distortion
+    StereoCalibration calibration{cv::Size(640, 480),
+        {cv::Matx33d(500, 0, 320, 0, 500, 240, 0, 0, 1), cv::Mat::zeros(1, 5, CV_64F)},
+        {cv::Matx33d(500, 0, 320, 0, 500, 240, 0, 0, 1), cv::Mat::zeros(1, 5, CV_64F)},
+        cv::Matx33d::eye(), cv::Vec3d(-0.1, 0, 0)};
+    
+    // Random texture with an object in front of a far background: the
+    // object is seen with disparity objectDisparity, the rest with 4
+    void makeScene(const cv::Rect& object, int objectDisparity) {
+        cv::Mat background(480, 640, CV_8UC1), foreground(480, 640, CV_8UC1);
+        cv::RNG rng(5);
+        rng.fill(background, cv::RNG::UNIFORM, 0, 256);
+        rng.fill(foreground, cv::RNG::UNIFORM, 0, 256);
+        
+        cv::Mat leftGray(480, 640, CV_8UC1), rightGray(480, 640, CV_8UC1);
+        for (int y = 0; y < 480; ++y) {
+            for (int x = 0; x < 640; ++x) {
+                leftGray.at<uint8_t>(y, x) = object.contains({x, y})
+                    ? foreground.at<uint8_t>(y, x) : background.at<uint8_t>(y, x);
+                const int shifted = x + objectDisparity;
+                rightGray.at<uint8_t>(y, x) = object.contains({shifted, y})
+                    ? foreground.at<uint8_t>(y, shifted)
+                    : background.at<uint8_t>(y, std::min(x + 4, 639));
+            }
+        }
+        cv::cvtColor(leftGray, left, cv::COLOR_GRAY2BGR);
+        cv::cvtColor(rightGray, right, cv::COLOR_GRAY2BGR);
+    }
+    
+    cv::Mat left;
+    cv::Mat right;
+};
+
+TEST_F(DepthEstimatorTest, MeasuresObjectsFromEitherEye) {
+    const cv::Rect object(260, 160, 100, 120);
+    makeScene(object, 20);
+    DepthEstimator depth(calibration, DepthEstimator::Config{});
+    
+    // Seen 20px further left by the right camera: 500 * 0.1 / 20
+    std::vector<YOLODetector::DetectionResult> leftDetections{{0, 0.9f, object, "person"}};
+    std::vector<YOLODetector::DetectionResult> rightDetections{
+        {0, 0.9f, object - cv::Point(20, 0), "person"}};
+    depth.estimate(left, right, DepthEstimator::Eye::Left, leftDetections);
+    depth.estimate(left, right, DepthEstimator::Eye::Right, rightDetections);
+    
+    EXPECT_NEAR(leftDetections[0].distance, 2.5f, 0.15f);
+    EXPECT_NEAR(rightDetections[0].distance, 2.5f, 0.15f);
+}
+
+TEST_F(DepthEstimatorTest, ProjectsLeftDetectionsIntoRightEye) {
+    const cv::Rect object(260, 160, 100, 120);
+    makeScene(object, 20);
+    DepthEstimator depth(calibration, DepthEstimator::Config{});
+    
+    std::vector<YOLODetector::DetectionResult> leftDetections{
+        {0, 0.9f, object, "person"},
+        {2, 0.7f, cv::Rect(450, 300, 80, 80), "car"}};  // on the background
+    std::vector<YOLODetector::DetectionResult> rightDetections;
+    depth.project(left, right, leftDetections, rightDetections);
+    
+    ASSERT_EQ(rightDetections.size(), 2u);
+    EXPECT_EQ(rightDetections[0].className, "person");
+    EXPECT_NEAR(rightDetections[0].box.x, object.x - 20, 1);
+    EXPECT_NEAR(rightDetections[0].box.y, object.y, 1);
+    EXPECT_NEAR(leftDetections[0].distance, 2.5f, 0.15f);
+    EXPECT_EQ(rightDetections[0].distance, leftDetections[0].distance);
+    EXPECT_NEAR(rightDetections[1].box.x, 450 - 4, 1);
+    EXPECT_NEAR(leftDetections[1].distance, 12.5f, 1.0f);
+}
+
+TEST_F(DepthEstimatorTest, UnmatchedProjectionsStayInPlace) {
+    left = cv::Mat(480, 640, CV_8UC3, cv::Scalar(90, 90, 90));
+    right = left.clone();
+    DepthEstimator depth(calibration, DepthEstimator::Config{});
+    
+    std::vector<YOLODetector::DetectionResult> leftDetections{
+        {0, 0.9f, cv::Rect(260, 160, 100, 120), "person"}};
+    std::vector<YOLODetector::DetectionResult> rightDetections;
+    depth.project(left, right, leftDetections, rightDetections);
+    
+    ASSERT_EQ(rightDetections.size(), 1u);
+    EXPECT_NEAR(rightDetections[0].box.x, 260, 1);
+    EXPECT_EQ(leftDetections[0].distance, 0.0f);
+}
+
+TEST_F(DepthEstimatorTest, TexturelessBoxesHaveUnknownDistance) {
+    left = cv::Mat(480, 640, CV_8UC3, cv::Scalar(90, 90, 90));
+    right = left.clone();
+    DepthEstimator depth(calibration, DepthEstimator::Config{});
+    
+    std::vector<YOLODetector::DetectionResult> detections{
+        {0, 0.9f, cv::Rect(260, 160, 100, 120), "person"},
+        {1, 0.8f, cv::Rect(0, 0, 20, 20), "bicycle"}};  // no room to search
+    depth.estimate(left, right, DepthEstimator::Eye::Left, detections);
+    
+    EXPECT_EQ(detections[0].distance, 0.0f);
+    EXPECT_EQ(detections[1].distance, 0.0f);
+}
+
+TEST_F(DepthEstimatorTest, RejectsFramesOfAnotherSize) {
+    DepthEstimator depth(calibration, DepthEstimator::Config{});
+    const cv::Mat small(240, 320, CV_8UC3, cv::Scalar::all(0));
+    std::vector<YOLODetector::DetectionResult> detections;
+    
+    EXPECT_THROW(depth.estimate(small, small, DepthEstimator::Eye::Left, detections),
+                 std::invalid_argument);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "tracking/object_tracker.hpp"
+
+using namespace rt;
+using namespace testing;
+
+class ObjectTrackerTest : public Test {
+protected:
+    void SetUp() override {
+        config.minHits = 2;
+        config.maxMisses = 3;
+    }
+    
+    static YOLODetector::DetectionResult person(int x, int y) {
+        return {0, 0.9f, cv::Rect(x, y, 50, 100), "person"};
+    }
+    
+    ObjectTracker::Config config;
+    std::vector<YOLODetector::DetectionResult> detections;
+};
+
+TEST_F(ObjectTrackerTest, ConfirmsTrackWithStableId) {
+    ObjectTracker tracker(config);
+    
+    detections = {person(100, 100)};
+    tracker.predict();
+    tracker.update(detections);
+    ASSERT_EQ(tracker.tracks().size(), 1u);
+    EXPECT_FALSE(tracker.tracks()[0].confirmed);
+    const int id = tracker.tracks()[0].id;
+    
+    detections = {person(104, 100)};
+    tracker.predict();
+    tracker.update(detections);
+    ASSERT_EQ(tracker.tracks().size(), 1u);
+    EXPECT_TRUE(tracker.tracks()[0].confirmed);
+    EXPECT_EQ(tracker.tracks()[0].id, id);
+    EXPECT_EQ(tracker.tracks()[0].className, "person");
+}
+
+TEST_F(ObjectTrackerTest, PropagatesBetweenDetections) {
+    ObjectTracker tracker(config);
+    
+    // Detected every third frame while moving 5 px per frame
+    for (int frame = 0; frame <= 9; frame += 3) {
+        detections = {person(100 + 5 * frame, 100)};
+        if (frame > 0) {
+            for (int i = 0; i < 3; ++i) {
+                tracker.predict();
+            }
+        }
+        tracker.update(detections);
+    }
+    ASSERT_EQ(tracker.tracks().size(), 1u);
+    
+    // Frames without detection keep the box moving
+    tracker.predict();
+    tracker.predict();
+    EXPECT_NEAR(tracker.tracks()[0].box.x, 155, 3);
+    EXPECT_EQ(tracker.tracks()[0].misses, 2);
+}
+
+TEST_F(ObjectTrackerTest, MatchesLateDetectionsAtTheirCaptureTime) {
+    ObjectTracker tracker(config);
+    
+    // Moving 20 px per frame, detected on frames 0 to 5
+    for (int frame = 0; frame <= 5; ++frame) {
+        detections = {person(100 + 20 * frame, 100)};
+        if (frame > 0) {
+            tracker.predict();
+        }
+        tracker.update(detections);
+    }
+    ASSERT_EQ(tracker.tracks().size(), 1u);
+    const int id = tracker.tracks()[0].id;
+    
+    // Frame 8 is shown when the detection of frame 5 arrives; the track is
+    // then 60 px past it and would not overlap at all
+    for (int i = 0; i < 3; ++i) {
+        tracker.predict();
+    }
+    detections = {person(200, 100)};
+    tracker.update(detections, 3.0f);
+    
+    ASSERT_EQ(tracker.tracks().size(), 1u);
+    EXPECT_EQ(tracker.tracks()[0].id, id);
+    EXPECT_EQ(tracker.tracks()[0].misses, 0);
+    EXPECT_NEAR(tracker.tracks()[0].box.x, 260, 6);
+}
+
+TEST_F(ObjectTrackerTest, MatchesOnlyWithinClass) {
+    ObjectTracker tracker(config);
+    detections = {person(100, 100)};
+    tracker.update(detections);
+    
+    detections[0].classId = 2;
+    tracker.predict();
+    tracker.update(detections);
+    
+    ASSERT_EQ(tracker.tracks().size(), 2u);
+    EXPECT_NE(tracker.tracks()[0].id, tracker.tracks()[1].id);
+}
+
+TEST_F(ObjectTrackerTest, DropsTracksAfterMaxMisses) {
+    ObjectTracker tracker(config);
+    detections = {person(100, 100), person(400, 100)};
+    tracker.update(detections);
+    
+    for (int i = 0; i < config.maxMisses; ++i) {
+        tracker.predict();
+    }
+    EXPECT_EQ(tracker.tracks().size(), 2u);
+    tracker.predict();
+    EXPECT_TRUE(tracker.tracks().empty());
+}
+
+TEST_F(ObjectTrackerTest, RefusesTracksBeyondCapacity) {
+    config.maxTracks = 1;
+    ObjectTracker tracker(config);
+    detections = {person(100, 100), person(400, 100)};
+    tracker.update(detections);
+    
+    EXPECT_EQ(tracker.tracks().size(), 1u);
+    EXPECT_EQ(tracker.dropped(), 1u);
+    EXPECT_THROW(ObjectTracker(ObjectTracker::Config{0.0f}), std::invalid_argument);
+}